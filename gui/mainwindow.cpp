@@ -1308,8 +1308,7 @@ void MainWindow::resetReportWidget(std::unique_ptr<core::RiskAnalysis> analysis)
                 table->setHorizontalHeaderLabels({tr("Product"), tr("Order"),
                                                   tr("Probability"),
                                                   tr("Contribution")});
-                for (const core::Product& product : products)
-                    sum += product.p();
+                sum = products.p_sum();
             } else {
                 table->setColumnCount(2);
                 table->setHorizontalHeaderLabels({tr("Product"), tr("Order")});
@@ -20,11 +20,16 @@
 
 #include "bdd.h"
 
+#include <algorithm>
+#include <limits>
+#include <map>
+
 #include <boost/multiprecision/miller_rabin.hpp>
 #include <boost/range/algorithm.hpp>
 
 #include "ext/find_iterator.h"
 #include "logger.h"
+#include "parallel.h"
 #include "zbdd.h"
 
 namespace scram {
@@ -39,12 +44,55 @@ int GetPrimeNumber(int n) {
   return n;
 }
 
+namespace {
+
+const int kMinGcThreshold = 1 << 18;  ///< The first garbage collection point.
+const int kMinReorderThreshold = 1 << 16;  ///< The first reordering point.
+const double kMaxSiftGrowth = 1.2;  ///< The limit on the BDD size in sifting.
+const int kMaxSiftVariables = 1000;  ///< The largest variables to sift.
+const int kMaxSwaps = 2e6;  ///< The limit on swaps per reordering.
+
+/// Logs the usage statistics of BDD hash tables.
+///
+/// @tparam Table  IteArena or CacheTable.
+///
+/// @param[in] name  The name of the table for the log.
+/// @param[in] table  The table with the hit/miss/collision counters.
+template <class Table>
+void LogTableStatistics(const char* name, const Table& table) {
+  LOG(DEBUG4) << "Hits/misses/collisions in " << name
+              << " table: " << table.hits() << "/" << table.misses() << "/"
+              << table.collisions();
+}
+
+}  // namespace
+
+const Ite::Handle Ite::kNull;
+const Ite::Handle Ite::kOne;
+const int Ite::kMaxOrder;
+
 Bdd::Bdd(const Pdag* graph, const Settings& settings)
     : kSettings_(settings),
+      root_{false, Ite::kNull},
       coherent_(graph->coherent()),
-      kOne_(new Terminal<Ite>(true)),
-      function_id_(2) {
+      gc_threshold_(kMinGcThreshold),
+      reorder_threshold_(kMinReorderThreshold) {
   TIMER(DEBUG3, "Converting PDAG into BDD");
+  bool parallel = kSettings_.bdd_fork_depth() && kSettings_.num_threads() > 1;
+  if (kSettings_.bdd_memory()) {  // Split between AND, OR, and XOR tables.
+    std::int64_t budget = std::int64_t(kSettings_.bdd_memory()) << 20;
+    // The serial tables are not used by the parallel Apply.
+    std::int64_t entry_size = parallel ? SharedCacheTable::entry_size()
+                                       : sizeof(ComputeTable::value_type);
+    int max_capacity = std::min<std::int64_t>(
+        budget / (3 * entry_size), std::numeric_limits<int>::max());
+    and_table_.max_capacity(max_capacity);
+    or_table_.max_capacity(max_capacity);
+    xor_table_.max_capacity(max_capacity);
+    shared_and_table_.max_capacity(max_capacity);
+    shared_or_table_.max_capacity(max_capacity);
+    shared_xor_table_.max_capacity(max_capacity);
+  }
   if (graph->IsTrivial()) {
     const Gate& top_gate = graph->root();
     assert(top_gate.args().size() == 1);
@@ -52,24 +100,43 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
     int child = *top_gate.args().begin();
     if (top_gate.constant()) {
       // Constant case should only happen to the top gate.
-      root_ = {child < 0, kOne_};
+      root_ = {child < 0, Ite::kOne};
     } else {
       const Variable& var = top_gate.args<Variable>().begin()->second;
-      root_ = {child < 0,
-               FindOrAddVertex(var.index(), kOne_, kOne_, true, var.order())};
+      root_ = {child < 0, FindOrAddVertex(var.index(), Ite::kOne, Ite::kOne,
+                                          true, var.order())};
       index_to_order_.emplace(var.index(), var.order());
     }
   } else {
-    std::unordered_map<int, std::pair<Function, int>> gates;
-    root_ = ConvertGraph(graph->root(), &gates);
+    if (parallel) {
+      LOG(DEBUG4) << "Parallel BDD Apply in " << kSettings_.num_threads()
+                  << " threads with the fork depth "
+                  << kSettings_.bdd_fork_depth();
+      pool_ = std::make_unique<TaskPool>(kSettings_.num_threads());
+      arena_.Share();
+      ClearSharedTables();
+    }
+    root_ = ConvertGraph(graph->root());
     root_.complement ^= graph->complement();
+    assert(gates_.empty() && stack_.empty());
+    if (kSettings_.reorder())
+      Reorder();
+    pool_.reset();  // No more Apply operations in parallel.
+    shared_and_table_.reserve(0);
+    shared_or_table_.reserve(0);
+    shared_xor_table_.reserve(0);
   }
   ClearMarks(false);
   TestStructure(root_.vertex);
-  LOG(DEBUG4) << "# of BDD vertices created: " << function_id_ - 1;
-  LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
+  LOG(DEBUG4) << "# of BDD vertices created: " << arena_.misses();
+  LOG(DEBUG4) << "# of vertices in BDD arena: " << arena_.size();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
+  LOG(DEBUG4) << "# of entries in XOR table: " << xor_table_.size();
+  LogTableStatistics("unique", arena_);
+  LogTableStatistics("AND", and_table_);
+  LogTableStatistics("OR", or_table_);
+  LogTableStatistics("XOR", xor_table_);
   ClearMarks(false);
   LOG(DEBUG4) << "# of ITE in BDD: " << CountIteNodes(root_.vertex);
   ClearMarks(false);
@@ -89,237 +156,653 @@ void Bdd::Analyze() noexcept {
     Freeze();
 }
 
-ItePtr Bdd::FindOrAddVertex(int index, const VertexPtr& high,
-                            const VertexPtr& low, bool complement_edge,
-                            int order) noexcept {
+Bdd::Handle Bdd::FindOrAddVertex(int index, Handle high, Handle low,
+                                 bool complement_edge, int order, bool module,
+                                 bool coherent) noexcept {
   assert(index > 0 && "Only positive indices are expected.");
-  IteWeakPtr& in_table =
-      unique_table_.FindOrAdd(index, high->id(),
-                              complement_edge ? -low->id() : low->id());
-  if (!in_table.expired())
-    return in_table.lock();
   assert(order > 0 && "Improper order.");
-  ItePtr ite(new Ite(index, order, function_id_++, high, low));
-  ite->complement_edge(complement_edge);
-  in_table = ite;
-  return ite;
+  Handle vertex = arena_.FindOrAdd(index, high, low, complement_edge, order,
+                                   module, coherent).first;
+  assert(arena_[vertex].module() == module);
+  assert(arena_[vertex].coherent() == coherent);
+  return vertex;
 }
 
-ItePtr Bdd::FindOrAddVertex(const ItePtr& ite, const VertexPtr& high,
-                            const VertexPtr& low,
-                            bool complement_edge) noexcept {
-  ItePtr in_table =
-      FindOrAddVertex(ite->index(), high, low, complement_edge, ite->order());
-  if (in_table->unique()) {
-    in_table->module(ite->module());
-    in_table->coherent(ite->coherent());
-  }
-  assert(in_table->module() == ite->module());
-  assert(in_table->coherent() == ite->coherent());
-  return in_table;
+Bdd::Handle Bdd::FindOrAddVertex(const Ite& ite, Handle high, Handle low,
+                                 bool complement_edge) noexcept {
+  return FindOrAddVertex(ite.index(), high, low, complement_edge, ite.order(),
+                         ite.module(), ite.coherent());
 }
 
-ItePtr Bdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
-                            const VertexPtr& low,
-                            bool complement_edge) noexcept {
+Bdd::Handle Bdd::FindOrAddVertex(const Gate& gate, Handle high, Handle low,
+                                 bool complement_edge) noexcept {
   assert(gate.module() && "Only module gates are expected for proxies.");
-  ItePtr in_table =
-      FindOrAddVertex(gate.index(), high, low, complement_edge, gate.order());
-  if (in_table->unique()) {
-    in_table->module(gate.module());
-    in_table->coherent(gate.coherent());
-  }
-  assert(in_table->module() == gate.module());
-  assert(in_table->coherent() == gate.coherent());
-  return in_table;
+  // The order of the module may have changed upon reordering.
+  int order = index_to_order_.emplace(gate.index(), gate.order()).first->second;
+  return FindOrAddVertex(gate.index(), high, low, complement_edge, order,
+                         gate.module(), gate.coherent());
 }
 
-Bdd::Function Bdd::ConvertGraph(
-    const Gate& gate,
-    std::unordered_map<int, std::pair<Function, int>>* gates) noexcept {
+Bdd::Function Bdd::ConvertGraph(const Gate& gate) noexcept {
   assert(!gate.constant() && "Unexpected constant gate!");
   Function result;  // For the NRVO, due to memoization.
   // Memoization check.
-  if (auto it_entry = ext::find(*gates, gate.index())) {
+  if (auto it_entry = ext::find(gates_, gate.index())) {
     std::pair<Function, int>& entry = it_entry->second;
     result = entry.first;
     assert(entry.second < gate.parents().size());  // Processed parents.
     if (++entry.second == gate.parents().size())
-      gates->erase(it_entry);
+      gates_.erase(it_entry);
     return result;
   }
-  std::vector<Function> args;
+  // The arguments are kept on the stack of the BDD
+  // to survive the garbage collection in the conversion of other arguments.
+  int frame = stack_.size();
   for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
-    args.push_back(
-        {arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
-                                        arg.second.order())});
-    index_to_order_.emplace(arg.second.index(), arg.second.order());
+    int order = index_to_order_.emplace(arg.second.index(), arg.second.order())
+                    .first->second;
+    stack_.push_back({arg.first < 0,
+                      FindOrAddVertex(arg.second.index(), Ite::kOne, Ite::kOne,
+                                      true, order)});
   }
   for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    Function res = ConvertGraph(arg.second, gates);
+    Function res = ConvertGraph(arg.second);
     if (arg.second.module()) {
-      args.push_back(
-          {arg.first < 0, FindOrAddVertex(arg.second, kOne_, kOne_, true)});
+      stack_.push_back({arg.first < 0, FindOrAddVertex(arg.second, Ite::kOne,
+                                                       Ite::kOne, true)});
     } else {
       bool complement = (arg.first < 0) ^ res.complement;
-      args.push_back({complement, res.vertex});
+      stack_.push_back({complement, res.vertex});
     }
   }
-  boost::sort(args, [](const Function& lhs, const Function& rhs) {
-    if (lhs.vertex->terminal())
-      return true;
-    if (rhs.vertex->terminal())
-      return false;
-    return Ite::Ref(lhs.vertex).order() > Ite::Ref(rhs.vertex).order();
-  });
-  auto it = args.cbegin();
-  for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result.vertex, it->vertex, result.complement,
-                   it->complement);
+  if (gate.type() == kVote) {
+    std::vector<Function> args(stack_.begin() + frame, stack_.end());
+    result = ApplyVote(gate.vote_number(), &args);
+  } else {
+    std::sort(stack_.begin() + frame, stack_.end(),
+              [this](const Function& lhs, const Function& rhs) {
+                if (terminal(lhs.vertex))
+                  return true;
+                if (terminal(rhs.vertex))
+                  return false;
+                return ite(lhs.vertex).order() > ite(rhs.vertex).order();
+              });
+    int num_args = stack_.size();
+    stack_.push_back(stack_[frame]);  // The partial result.
+    for (int i = frame + 1; i < num_args; ++i) {
+      Function arg = stack_[i];
+      Function partial = stack_.back();
+      stack_.back() = Apply(gate.type(), partial.vertex, arg.vertex,
+                            partial.complement, arg.complement);
+      if (arena_.size() > gc_threshold_)
+        CollectGarbage();  // The safe point between operations.
+    }
+    result = stack_.back();
   }
+  stack_.resize(frame);
   ClearTables();
-  assert(result.vertex);
+  assert(result);
   if (gate.module())
     modules_.emplace(gate.index(), result);
   if (gate.parents().size() > 1)
-    gates->insert({gate.index(), {result, 1}});
+    gates_.insert({gate.index(), {result, 1}});
+  // The safe point for the garbage collection and reordering.
+  // The arena keeps unreachable vertices until the garbage collection,
+  // so the live vertices are counted only upon the arena growth.
+  // The reordering starts early enough
+  // not to collect garbage on every gate around the threshold.
+  stack_.push_back(result);
+  if (kSettings_.reorder() && arena_.size() > reorder_threshold_) {
+    CollectGarbage();
+    if (4 * arena_.size() > 3 * reorder_threshold_)
+      Reorder();
+  } else if (arena_.size() > gc_threshold_) {
+    CollectGarbage();
+  }
+  stack_.pop_back();
   return result;
 }
 
-std::pair<int, int> Bdd::GetMinMaxId(const VertexPtr& arg_one,
-                                     const VertexPtr& arg_two,
+std::pair<int, int> Bdd::GetMinMaxId(Handle arg_one, Handle arg_two,
                                      bool complement_one,
                                      bool complement_two) noexcept {
-  assert(!arg_one->terminal() && !arg_two->terminal());
-  assert(arg_one->id() && arg_two->id());
-  assert(arg_one->id() != arg_two->id());
-  int min_id = arg_one->id() * (complement_one ? -1 : 1);
-  int max_id = arg_two->id() * (complement_two ? -1 : 1);
-  if (arg_one->id() > arg_two->id())
+  assert(!terminal(arg_one) && !terminal(arg_two));
+  assert(arg_one && arg_two);
+  assert(arg_one != arg_two);
+  int min_id = static_cast<int>(arg_one) * (complement_one ? -1 : 1);
+  int max_id = static_cast<int>(arg_two) * (complement_two ? -1 : 1);
+  if (arg_one > arg_two)
     std::swap(min_id, max_id);
   return {min_id, max_id};
 }
 
+/// Specialization of the reduction for AND operator with BDD vertices.
+template <>
+bool Bdd::Reduce<kAnd>(Handle arg_one, Handle arg_two, bool complement_one,
+                       bool complement_two, Function* result) noexcept {
+  assert(arg_one && arg_two);  // Both are reduced function graphs.
+  if (terminal(arg_one)) {
+    *result = complement_one ? Function{true, Ite::kOne}
+                             : Function{complement_two, arg_two};
+    return true;
+  }
+  if (terminal(arg_two)) {
+    *result = complement_two ? Function{true, Ite::kOne}
+                             : Function{complement_one, arg_one};
+    return true;
+  }
+  if (arg_one == arg_two) {  // Reduction detection.
+    *result = complement_one ^ complement_two
+                  ? Function{true, Ite::kOne}
+                  : Function{complement_one, arg_one};
+    return true;
+  }
+  return false;
+}
+
+/// Specialization of the reduction for OR operator with BDD vertices.
+template <>
+bool Bdd::Reduce<kOr>(Handle arg_one, Handle arg_two, bool complement_one,
+                      bool complement_two, Function* result) noexcept {
+  assert(arg_one && arg_two);  // Both are reduced function graphs.
+  if (terminal(arg_one)) {
+    *result = !complement_one ? Function{false, Ite::kOne}
+                              : Function{complement_two, arg_two};
+    return true;
+  }
+  if (terminal(arg_two)) {
+    *result = !complement_two ? Function{false, Ite::kOne}
+                              : Function{complement_one, arg_one};
+    return true;
+  }
+  if (arg_one == arg_two) {  // Reduction detection.
+    *result = complement_one ^ complement_two
+                  ? Function{false, Ite::kOne}
+                  : Function{complement_one, arg_one};
+    return true;
+  }
+  return false;
+}
+
+/// Specialization of the reduction for XOR operator with BDD vertices.
+template <>
+bool Bdd::Reduce<kXor>(Handle arg_one, Handle arg_two, bool complement_one,
+                       bool complement_two, Function* result) noexcept {
+  assert(arg_one && arg_two);  // Both are reduced function graphs.
+  bool complement = complement_one ^ complement_two;
+  if (terminal(arg_one)) {
+    *result = {!complement, arg_two};
+    return true;
+  }
+  if (terminal(arg_two)) {
+    *result = {!complement, arg_one};
+    return true;
+  }
+  if (arg_one == arg_two) {  // Reduction detection.
+    *result = {!complement, Ite::kOne};
+    return true;
+  }
+  return false;
+}
+
 /// Specialization of Apply for AND operator with BDD vertices.
 template <>
-Bdd::Function Bdd::Apply<kAnd>(const VertexPtr& arg_one,
-                               const VertexPtr& arg_two, bool complement_one,
+Bdd::Function Bdd::Apply<kAnd>(Handle arg_one, Handle arg_two,
+                               bool complement_one,
                                bool complement_two) noexcept {
-  assert(arg_one->id() && arg_two->id());  // Both are reduced function graphs.
-  if (arg_one->terminal()) {
-    if (complement_one)
-      return {true, kOne_};
-    return {complement_two, arg_two};
-  }
-  if (arg_two->terminal()) {
-    if (complement_two)
-      return {true, kOne_};
-    return {complement_one, arg_one};
-  }
-  if (arg_one->id() == arg_two->id()) {  // Reduction detection.
-    if (complement_one ^ complement_two)
-      return {true, kOne_};
-    return {complement_one, arg_one};
-  }
+  Function result;
+  if (Reduce<kAnd>(arg_one, arg_two, complement_one, complement_two, &result))
+    return result;
   std::pair<int, int> min_max_id =
       GetMinMaxId(arg_one, arg_two, complement_one, complement_two);
   if (auto it = ext::find(and_table_, min_max_id))
     return it->second;
-  Function result = Apply<kAnd>(Ite::Ptr(arg_one), Ite::Ptr(arg_two),
-                                complement_one, complement_two);
+  result = ApplyIte<kAnd>(arg_one, arg_two, complement_one, complement_two);
   and_table_.emplace(min_max_id, result);
   return result;
 }
 
 /// Specialization of Apply for OR operator with BDD vertices.
 template <>
-Bdd::Function Bdd::Apply<kOr>(const VertexPtr& arg_one,
-                              const VertexPtr& arg_two, bool complement_one,
+Bdd::Function Bdd::Apply<kOr>(Handle arg_one, Handle arg_two,
+                              bool complement_one,
                               bool complement_two) noexcept {
-  assert(arg_one->id() && arg_two->id());  // Both are reduced function graphs.
-  if (arg_one->terminal()) {
-    if (!complement_one)
-      return {false, kOne_};
-    return {complement_two, arg_two};
-  }
-  if (arg_two->terminal()) {
-    if (!complement_two)
-      return {false, kOne_};
-    return {complement_one, arg_one};
-  }
-  if (arg_one->id() == arg_two->id()) {  // Reduction detection.
-    if (complement_one ^ complement_two)
-      return {false, kOne_};
-    return {complement_one, arg_one};
-  }
+  Function result;
+  if (Reduce<kOr>(arg_one, arg_two, complement_one, complement_two, &result))
+    return result;
   std::pair<int, int> min_max_id =
       GetMinMaxId(arg_one, arg_two, complement_one, complement_two);
   if (auto it = ext::find(or_table_, min_max_id))
     return it->second;
-  Function result = Apply<kOr>(Ite::Ptr(arg_one), Ite::Ptr(arg_two),
-                               complement_one, complement_two);
+  result = ApplyIte<kOr>(arg_one, arg_two, complement_one, complement_two);
   or_table_.emplace(min_max_id, result);
   return result;
 }
 
+/// Specialization of Apply for XOR operator with BDD vertices.
+/// The complements are factored out: (~f ^ g) = ~(f ^ g).
+template <>
+Bdd::Function Bdd::Apply<kXor>(Handle arg_one, Handle arg_two,
+                               bool complement_one,
+                               bool complement_two) noexcept {
+  Function result;
+  if (Reduce<kXor>(arg_one, arg_two, complement_one, complement_two, &result))
+    return result;
+  std::pair<int, int> min_max_id = std::minmax(static_cast<int>(arg_one),
+                                               static_cast<int>(arg_two));
+  if (auto it = ext::find(xor_table_, min_max_id)) {
+    result = it->second;
+  } else {
+    result = ApplyIte<kXor>(arg_one, arg_two, false, false);
+    xor_table_.emplace(min_max_id, result);
+  }
+  result.complement ^= complement_one ^ complement_two;
+  return result;
+}
+
 template <Operator Type>
-Bdd::Function Bdd::Apply(ItePtr ite_one, ItePtr ite_two,
-                         bool complement_one,
-                         bool complement_two) noexcept {
-  if (ite_one->order() > ite_two->order()) {
-    ite_one.swap(ite_two);
+Bdd::Function Bdd::ApplyIte(Handle ite_one, Handle ite_two,
+                            bool complement_one,
+                            bool complement_two) noexcept {
+  if (arena_[ite_one].order() > arena_[ite_two].order()) {
+    std::swap(ite_one, ite_two);
     std::swap(complement_one, complement_two);
   }
+  // The references are stable upon the growth of the arena.
+  const Ite& one = arena_[ite_one];
+  const Ite& two = arena_[ite_two];
 
   Function high;
   Function low;
-  if (ite_one->order() == ite_two->order()) {  // The same variable.
-    assert(ite_one->index() == ite_two->index());
-    high = Apply<Type>(ite_one->high(), ite_two->high(), complement_one,
-                       complement_two);
-    low = Apply<Type>(ite_one->low(), ite_two->low(),
-                      complement_one ^ ite_one->complement_edge(),
-                      complement_two ^ ite_two->complement_edge());
+  if (one.order() == two.order()) {  // The same variable.
+    assert(one.index() == two.index());
+    high = Apply<Type>(one.high(), two.high(), complement_one, complement_two);
+    low = Apply<Type>(one.low(), two.low(),
+                      complement_one ^ one.complement_edge(),
+                      complement_two ^ two.complement_edge());
   } else {
-    assert(ite_one->order() < ite_two->order());
-    high =
-        Apply<Type>(ite_one->high(), ite_two, complement_one, complement_two);
-    low = Apply<Type>(ite_one->low(), ite_two,
-                      complement_one ^ ite_one->complement_edge(),
-                      complement_two);
+    assert(one.order() < two.order());
+    high = Apply<Type>(one.high(), ite_two, complement_one, complement_two);
+    low = Apply<Type>(one.low(), ite_two,
+                      complement_one ^ one.complement_edge(), complement_two);
   }
 
   bool complement_edge = high.complement ^ low.complement;
-  if (complement_edge || (high.vertex->id() != low.vertex->id())) {
-    high.vertex =
-        FindOrAddVertex(ite_one, high.vertex, low.vertex, complement_edge);
+  if (complement_edge || (high.vertex != low.vertex))
+    high.vertex = FindOrAddVertex(one, high.vertex, low.vertex, complement_edge);
+
+  return high;
+}
+
+template <Operator Type>
+Bdd::Function Bdd::ApplyShared(Handle arg_one, Handle arg_two,
+                               bool complement_one, bool complement_two,
+                               int depth) noexcept {
+  Function result;
+  if (Reduce<Type>(arg_one, arg_two, complement_one, complement_two, &result))
+    return result;
+  bool complement = false;
+  if (Type == kXor) {  // The complements are factored out as in Apply<kXor>.
+    complement = complement_one ^ complement_two;
+    complement_one = complement_two = false;
+  }
+  SharedCacheTable& table = Type == kAnd  ? shared_and_table_
+                            : Type == kOr ? shared_or_table_
+                                          : shared_xor_table_;
+  std::pair<int, int> min_max_id =
+      GetMinMaxId(arg_one, arg_two, complement_one, complement_two);
+  if (std::uint32_t value = table.find(min_max_id)) {
+    result = Unpack(value);
+  } else {
+    result = ApplyIteShared<Type>(arg_one, arg_two, complement_one,
+                                  complement_two, depth);
+    table.emplace(min_max_id, Pack(result));
+  }
+  result.complement ^= complement;
+  return result;
+}
+
+template <Operator Type>
+Bdd::Function Bdd::ApplyIteShared(Handle ite_one, Handle ite_two,
+                                  bool complement_one, bool complement_two,
+                                  int depth) noexcept {
+  if (arena_[ite_one].order() > arena_[ite_two].order()) {
+    std::swap(ite_one, ite_two);
+    std::swap(complement_one, complement_two);
+  }
+  // The vertices are immutable while shared.
+  const Ite& one = arena_[ite_one];
+  const Ite& two = arena_[ite_two];
+  Handle high_two = ite_two;
+  Handle low_two = ite_two;
+  bool low_complement_two = complement_two;
+  if (one.order() == two.order()) {  // The same variable.
+    assert(one.index() == two.index());
+    high_two = two.high();
+    low_two = two.low();
+    low_complement_two ^= two.complement_edge();
+  } else {
+    assert(one.order() < two.order());
+  }
+  bool low_complement_one = complement_one ^ one.complement_edge();
+
+  Function high;
+  Function low;
+  if (depth < kSettings_.bdd_fork_depth() && !terminal(one.high()) &&
+      !terminal(high_two) && one.high() != high_two) {
+    TaskPool::Task task([&] {
+      high = ApplyShared<Type>(one.high(), high_two, complement_one,
+                               complement_two, depth + 1);
+    });
+    pool_->Fork(&task);
+    low = ApplyShared<Type>(one.low(), low_two, low_complement_one,
+                            low_complement_two, depth + 1);
+    pool_->Join(&task);
+  } else {
+    high = ApplyShared<Type>(one.high(), high_two, complement_one,
+                             complement_two, depth + 1);
+    low = ApplyShared<Type>(one.low(), low_two, low_complement_one,
+                            low_complement_two, depth + 1);
   }
 
+  bool complement_edge = high.complement ^ low.complement;
+  if (complement_edge || (high.vertex != low.vertex)) {
+    high.vertex = arena_.FindOrAddShared(one.index(), high.vertex, low.vertex,
+                                         complement_edge, one.order(),
+                                         one.module(), one.coherent()).first;
+  }
   return high;
 }
 
-Bdd::Function Bdd::Apply(Operator type,
-                         const VertexPtr& arg_one, const VertexPtr& arg_two,
+Bdd::Function Bdd::Apply(Operator type, Handle arg_one, Handle arg_two,
                          bool complement_one, bool complement_two) noexcept {
-  assert(arg_one->id() && arg_two->id());  // Both are reduced function graphs.
+  assert(arg_one && arg_two);  // Both are reduced function graphs.
+  if (pool_) {
+    if (type == kAnd)
+      return ApplyShared<kAnd>(arg_one, arg_two, complement_one,
+                               complement_two, 0);
+    if (type == kXor)
+      return ApplyShared<kXor>(arg_one, arg_two, complement_one,
+                               complement_two, 0);
+    assert(type == kOr && "Unsupported operator.");
+    return ApplyShared<kOr>(arg_one, arg_two, complement_one, complement_two,
+                            0);
+  }
   if (type == kAnd) {
     return Apply<kAnd>(arg_one, arg_two, complement_one, complement_two);
   }
+  if (type == kXor) {
+    return Apply<kXor>(arg_one, arg_two, complement_one, complement_two);
+  }
   assert(type == kOr && "Unsupported operator.");
   return Apply<kOr>(arg_one, arg_two, complement_one, complement_two);
 }
 
-Bdd::Function Bdd::CalculateConsensus(const ItePtr& ite,
-                                      bool complement) noexcept {
+Bdd::Function Bdd::ApplyVote(int vote_number,
+                             std::vector<Function>* args) noexcept {
+  int num_args = args->size();
+  assert(vote_number > 1 && vote_number < num_args && "Malformed K/N gate.");
+  // The bottom arguments are consumed first,
+  // so every step only adds a top layer to the partial functions.
+  boost::sort(*args, [this](const Function& lhs, const Function& rhs) {
+    if (terminal(lhs.vertex))
+      return false;
+    if (terminal(rhs.vertex))
+      return true;
+    return ite(lhs.vertex).order() < ite(rhs.vertex).order();
+  });
+  // at_least[k] is (at least k of the consumed arguments are true):
+  // T(i, k) = OR(AND(x_i, T(i + 1, k - 1)), T(i + 1, k)).
+  std::vector<Function> at_least(vote_number + 1, {true, Ite::kOne});
+  at_least[0] = {false, Ite::kOne};
+  for (int i = num_args - 1; i >= 0; --i) {
+    const Function& arg = (*args)[i];
+    // The remaining i arguments can add at most i votes.
+    int min_votes = std::max(1, vote_number - i);
+    for (int k = std::min(vote_number, num_args - i); k >= min_votes; --k) {
+      Function vote = Apply(kAnd, arg.vertex, at_least[k - 1].vertex,
+                            arg.complement, at_least[k - 1].complement);
+      at_least[k] = Apply(kOr, vote.vertex, at_least[k].vertex,
+                          vote.complement, at_least[k].complement);
+    }
+  }
+  return at_least[vote_number];
+}
+
+Bdd::Function Bdd::CalculateConsensus(Handle ite, bool complement) noexcept {
   ClearTables();
-  return Apply<kAnd>(ite->high(), ite->low(), complement,
-                     ite->complement_edge() ^ complement);
+  const Ite& vertex = arena_[ite];
+  return Apply<kAnd>(vertex.high(), vertex.low(), complement,
+                     vertex.complement_edge() ^ complement);
+}
+
+template <class F>
+void Bdd::VisitRoots(F&& visit) noexcept {
+  if (root_)
+    visit(root_);
+  for (const auto& module : modules_)
+    visit(module.second);
+  for (const auto& gate : gates_)
+    visit(gate.second.first);
+  for (const Function& function : stack_)
+    visit(function);
+}
+
+void Bdd::CollectGarbage() noexcept {
+  ClearTables();  // The results may refer to the recycled handles.
+  VisitRoots([this](const Function& root) { arena_.Mark(root.vertex); });
+  int num_dead = arena_.Sweep();
+  gc_threshold_ = std::max(kMinGcThreshold, 2 * arena_.size());
+  ClearSharedTables();
+  LOG(DEBUG5) << "Collected " << num_dead << " BDD vertices with "
+              << arena_.size() << " live vertices";
+}
+
+void Bdd::ClearSharedTables() noexcept {
+  if (!pool_)
+    return;
+  // The tables are as large as the BDD between the collections.
+  int capacity = std::max(kMinGcThreshold, arena_.size());
+  shared_and_table_.reserve(capacity);
+  shared_or_table_.reserve(capacity);
+  shared_xor_table_.reserve(capacity);
+}
+
+void Bdd::Reorder() noexcept {
+  CLOCK(reorder_time);
+  CollectGarbage();
+  std::vector<Level> levels = GatherLevels();
+  int size = 0;
+  for (const Level& level : levels)
+    size += level.vertices.size();
+  int initial_size = size;
+  LOG(DEBUG3) << "Reordering " << levels.size()
+              << " BDD variables with sifting...";
+  LOG(DEBUG4) << "# of BDD vertices before reordering: " << size;
+
+  // The variables with more vertices are sifted first.
+  std::vector<std::pair<int, int>> candidates;  // {size, index}
+  for (const Level& level : levels)
+    candidates.emplace_back(level.vertices.size(), level.index);
+  std::sort(candidates.rbegin(), candidates.rend());
+  if (candidates.size() > kMaxSiftVariables)
+    candidates.resize(kMaxSiftVariables);
+
+  int num_swaps = 0;
+  int last = static_cast<int>(levels.size()) - 1;
+  for (const std::pair<int, int>& candidate : candidates) {
+    int position = std::find_if(levels.begin(), levels.end(),
+                                [&candidate](const Level& level) {
+                                  return level.index == candidate.second;
+                                }) -
+                   levels.begin();
+    int best_size = size;
+    int best_position = position;
+    auto sift = [&](int step, int end) {
+      while (position != end && num_swaps < kMaxSwaps &&
+             size <= kMaxSiftGrowth * best_size) {
+        size += SwapLevels(&levels, step > 0 ? position : position - 1);
+        position += step;
+        ++num_swaps;
+        if (size < best_size) {
+          best_size = size;
+          best_position = position;
+        }
+      }
+    };
+    if (position > last / 2) {  // The closer end first.
+      sift(1, last);
+      sift(-1, 0);
+    } else {
+      sift(-1, 0);
+      sift(1, last);
+    }
+    for (; position < best_position; ++position)
+      size += SwapLevels(&levels, position);
+    for (; position > best_position; --position)
+      size += SwapLevels(&levels, position - 1);
+    // Dead vertices left in the levels may only shrink the size.
+    assert(size <= best_size && "Inconsistent BDD size upon sifting.");
+  }
+  for (const Level& level : levels)
+    index_to_order_[level.index] = level.order;
+  refs_ = std::vector<int>();  // The dead vertices are left for collection.
+  ClearSharedTables();  // The freed vertices may have been recycled.
+  reorder_threshold_ = std::max(kMinReorderThreshold, 2 * size);
+  LOG(DEBUG4) << "# of BDD vertices after reordering: " << size;
+  LOG(DEBUG3) << "Reordered BDD variables (" << initial_size << " -> " << size
+              << " vertices) with " << num_swaps << " swaps in "
+              << DUR(reorder_time);
+}
+
+std::vector<Bdd::Level> Bdd::GatherLevels() noexcept {
+  // The references are counted only for the reordering
+  // to discover the vertices dying upon the swaps of levels.
+  refs_.assign(arena_.capacity(), 0);
+  VisitRoots([this](const Function& root) { ++refs_[root.vertex]; });
+  std::map<int, Level> orders;
+  arena_.ForEach([this, &orders](Handle vertex, const Ite& ite) {
+    ++refs_[ite.high()];
+    ++refs_[ite.low()];
+    Level& level = orders[ite.order()];
+    if (level.vertices.empty()) {
+      level.index = ite.index();
+      level.order = ite.order();
+      level.module = ite.module();
+      level.coherent = ite.coherent();
+    }
+    assert(level.index == ite.index() && "Inconsistent variable order.");
+    level.vertices.push_back(vertex);
+  });
+  std::vector<Level> levels;
+  for (auto& entry : orders)
+    levels.push_back(std::move(entry.second));
+  return levels;
+}
+
+int Bdd::SwapLevels(std::vector<Level>* levels, int position) noexcept {
+  Level& upper = (*levels)[position];
+  Level& lower = (*levels)[position + 1];
+  int initial_size = upper.vertices.size() + lower.vertices.size();
+  std::swap(upper.order, lower.order);
+  // Vertices may die upon the release of their parents in earlier swaps.
+  // These must go before the lookups for the swapped functions.
+  std::vector<Handle> upper_vertices;
+  for (Handle vertex : upper.vertices) {
+    if (!refs_[vertex]) {
+      FreeVertex(vertex);  // Keeps the table free of dead vertices.
+      continue;
+    }
+    upper_vertices.push_back(vertex);
+  }
+  upper.vertices.clear();
+  std::vector<Handle> lower_vertices;  // The swapped functions.
+  for (Handle vertex : upper_vertices) {
+    assert(refs_[vertex] && "Unexpected dead vertex.");
+    Ite& ite = arena_[vertex];
+    auto depends = [this, &lower](Handle child) {
+      return !terminal(child) && arena_[child].index() == lower.index;
+    };
+    bool high_depends = depends(ite.high());
+    bool low_depends = depends(ite.low());
+    if (!high_depends && !low_depends) {
+      ite.order(upper.order);
+      upper.vertices.push_back(vertex);
+      continue;
+    }
+    // Cofactors with respect to the lower variable.
+    auto cofactors = [this](const Function& function, bool dependent) {
+      if (!dependent)
+        return std::make_pair(function, function);
+      const Ite& child = arena_[function.vertex];
+      return std::make_pair(
+          Function{function.complement, child.high()},
+          Function{function.complement != child.complement_edge(),
+                   child.low()});
+    };
+    std::pair<Function, Function> high =
+        cofactors({false, ite.high()}, high_depends);
+    std::pair<Function, Function> low =
+        cofactors({ite.complement_edge(), ite.low()}, low_depends);
+    Function new_high = FindOrAddFunction(&upper, high.first, low.first);
+    Function new_low = FindOrAddFunction(&upper, high.second, low.second);
+    assert(!new_high.complement && "Complement high edge.");
+    // The new branches are referenced before the release of the old ones.
+    ++refs_[new_high.vertex];
+    ++refs_[new_low.vertex];
+    --refs_[ite.high()];
+    --refs_[ite.low()];
+    arena_.Erase(vertex);
+    ite.Reset(lower.index, lower.order, new_high.vertex, new_low.vertex,
+              new_low.complement, lower.module, lower.coherent);
+    arena_.Insert(vertex);
+    lower_vertices.push_back(vertex);
+  }
+  // The vertices of the lower variable without references are dead.
+  for (Handle vertex : lower.vertices) {
+    if (!refs_[vertex]) {
+      FreeVertex(vertex);
+      continue;
+    }
+    arena_[vertex].order(lower.order);
+    lower_vertices.push_back(vertex);
+  }
+  lower.vertices.swap(lower_vertices);
+  std::swap(upper, lower);
+  int final_size = upper.vertices.size() + lower.vertices.size();
+  return final_size - initial_size;
+}
+
+Bdd::Function Bdd::FindOrAddFunction(Level* level, const Function& high,
+                                     const Function& low) noexcept {
+  if (high.vertex == low.vertex && high.complement == low.complement)
+    return high;  // Reduction.
+  std::pair<Handle, bool> in_table = arena_.FindOrAdd(
+      level->index, high.vertex, low.vertex, high.complement ^ low.complement,
+      level->order, level->module, level->coherent);
+  if (in_table.second) {  // Newly created.
+    level->vertices.push_back(in_table.first);
+    if (in_table.first >= refs_.size())
+      refs_.resize(arena_.capacity(), 0);
+    refs_[in_table.first] = 0;
+    ++refs_[high.vertex];
+    ++refs_[low.vertex];
+  }
+  return {high.complement, in_table.first};
+}
+
+void Bdd::FreeVertex(Handle vertex) noexcept {
+  assert(!refs_[vertex] && "Freeing a referenced vertex.");
+  const Ite& ite = arena_[vertex];
+  --refs_[ite.high()];
+  --refs_[ite.low()];
+  arena_.Free(vertex);
 }
 
-int Bdd::CountIteNodes(const VertexPtr& vertex) noexcept {
-  if (vertex->terminal())
+int Bdd::CountIteNodes(Handle vertex) noexcept {
+  if (terminal(vertex))
     return 0;
-  Ite& ite = Ite::Ref(vertex);
+  Ite& ite = arena_[vertex];
   if (ite.mark())
     return 0;
   ite.mark(true);
@@ -331,10 +814,10 @@ int Bdd::CountIteNodes(const VertexPtr& vertex) noexcept {
   return 1 + in_module + CountIteNodes(ite.high()) + CountIteNodes(ite.low());
 }
 
-void Bdd::ClearMarks(const VertexPtr& vertex, bool mark) noexcept {
-  if (vertex->terminal())
+void Bdd::ClearMarks(Handle vertex, bool mark) noexcept {
+  if (terminal(vertex))
     return;
-  Ite& ite = Ite::Ref(vertex);
+  Ite& ite = arena_[vertex];
   if (ite.mark() == mark)
     return;
   ite.mark(mark);
@@ -346,28 +829,27 @@ void Bdd::ClearMarks(const VertexPtr& vertex, bool mark) noexcept {
   ClearMarks(ite.low(), mark);
 }
 
-void Bdd::TestStructure(const VertexPtr& vertex) noexcept {
-  if (vertex->terminal())
+void Bdd::TestStructure(Handle vertex) noexcept {
+  if (terminal(vertex))
     return;
-  Ite& ite = Ite::Ref(vertex);
+  Ite& ite = arena_[vertex];
   if (ite.mark())
     return;
   ite.mark(true);
   assert(ite.index() && "Illegal index for a node.");
   assert(ite.order() && "Improper order for nodes.");
-  assert(ite.high() && ite.low() && "Malformed node high/low pointers.");
-  assert(
-      !(!ite.complement_edge() && ite.high()->id() == ite.low()->id()) &&
-      "Reduction rule failure.");
-  assert(!(!ite.high()->terminal() &&
-           ite.order() >= Ite::Ref(ite.high()).order()) &&
+  assert(ite.high() && ite.low() && "Malformed node high/low handles.");
+  assert(!(!ite.complement_edge() && ite.high() == ite.low()) &&
+         "Reduction rule failure.");
+  assert(!(!terminal(ite.high()) &&
+           ite.order() >= arena_[ite.high()].order()) &&
          "Ordering of nodes failed.");
-  assert(!(!ite.low()->terminal() &&
-           ite.order() >= Ite::Ref(ite.low()).order()) &&
+  assert(!(!terminal(ite.low()) &&
+           ite.order() >= arena_[ite.low()].order()) &&
          "Ordering of nodes failed.");
   if (ite.module()) {
     const Function& res = modules_.find(ite.index())->second;
-    assert(!res.vertex->terminal() && "Terminal modules must be removed.");
+    assert(!terminal(res.vertex) && "Terminal modules must be removed.");
     TestStructure(res.vertex);
   }
   TestStructure(ite.high());
@@ -22,10 +22,12 @@
 #define SCRAM_SRC_BDD_H_
 
 #include <cmath>
+#include <cstdint>
 
 #include <algorithm>
-#include <forward_list>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -113,6 +115,14 @@ class WeakIntrusivePtr final : private boost::noncopyable {
       vertex_->table_ptr_ = nullptr;
   }
 
+  /// Detaches the vertex from this pointer.
+  void reset() noexcept {
+    if (vertex_) {
+      vertex_->table_ptr_ = nullptr;
+      vertex_ = nullptr;
+    }
+  }
+
   /// @returns true if the managed vertex is deleted or not initialized.
   bool expired() const { return !vertex_; }
 
@@ -277,6 +287,14 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
     return order_;
   }
 
+  /// Sets the new order of the vertex variable upon variable reordering.
+  ///
+  /// @param[in] order  The new positive order of the variable.
+  void order(int order) {
+    assert(order > 0);
+    order_ = order;
+  }
+
   /// @returns true if this vertex represents a module gate.
   bool module() const { return module_; }
 
@@ -300,6 +318,29 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
   /// @returns (0/False/else/right) branch vertex.
   const VertexPtr& low() const { return low_; }
 
+  /// Replaces the variable and branches of this vertex in place.
+  /// This is a facility for variable reordering,
+  /// which must preserve the function represented by the vertex.
+  ///
+  /// @param[in] index  Index of the new variable.
+  /// @param[in] order  Order of the new variable.
+  /// @param[in] high  The new high vertex.
+  /// @param[in] low  The new low vertex.
+  /// @param[in] module  The indication of a module variable.
+  /// @param[in] coherent  The indication of a coherent module.
+  ///
+  /// @warning The vertex must be out of the unique table for the change.
+  void Reset(int index, int order, const VertexPtr& high, const VertexPtr& low,
+             bool module, bool coherent) {
+    assert(order > 0);
+    index_ = index;
+    order_ = order;
+    high_ = high;
+    low_ = low;
+    module_ = module;
+    coherent_ = coherent;
+  }
+
   /// @returns The mark of this vertex.
   bool mark() const { return mark_; }
 
@@ -321,59 +362,6 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
   bool mark_;  ///< Traversal mark.
 };
 
-/// Representation of non-terminal if-then-else vertices in BDD graphs.
-/// This class is designed to help construct and manipulate BDD graphs.
-///
-/// This class provides one attributed complement edge.
-/// The attributed edge applies to the low/false/0 branch of the vertex.
-/// However, there is no logic to check
-/// if the complement edge manipulations are valid.
-/// Consistency is the responsibility of BDD algorithms and users.
-class Ite : public NonTerminal<Ite> {
-  /// Special handling of the complement flag in computing low id signature.
-  ///
-  /// @param[in] ite  Ite vertex.
-  ///
-  /// @returns The signed number for complement low id.
-  friend int get_low_id(const Ite& ite) noexcept {
-    return ite.complement_edge_ ? -ite.low()->id() : ite.low()->id();
-  }
-
- public:
-  using NonTerminal::NonTerminal;
-
-  /// @returns true if the low edge is complement.
-  bool complement_edge() const { return complement_edge_; }
-
-  /// Sets the complement flag for the low edge.
-  ///
-  /// @param[in] flag  Indicator to treat the low branch as a complement.
-  void complement_edge(bool flag) { complement_edge_ = flag; }
-
-  /// @returns The probability of the function graph.
-  double p() const { return p_; }
-
-  /// Sets the probability of the function graph.
-  ///
-  /// @param[in] value  Calculated value for the probability.
-  void p(double value) { p_ = value; }
-
-  /// @returns Saved results of importance factor calculations.
-  double factor() const { return factor_; }
-
-  /// Memorized results of importance factor calculations.
-  ///
-  /// @param[in] value  Calculation results for importance factor.
-  void factor(double value) { factor_ = value; }
-
- private:
-  bool complement_edge_ = false;  ///< Flag for complement edge.
-  double p_ = 0;  ///< Probability of the function graph.
-  double factor_ = 0;  ///< Importance factor calculation results.
-};
-
-using ItePtr = IntrusivePtr<Ite>;  ///< Shared if-then-else vertices.
-
 /// Prime number generation for hash tables.
 ///
 /// @param[in] n  The starting candidate for a prime number.
@@ -381,6 +369,25 @@ using ItePtr = IntrusivePtr<Ite>;  ///< Shared if-then-else vertices.
 /// @returns Probable prime number >= n.
 int GetPrimeNumber(int n);
 
+/// Computes the hash value of the unique signature of a BDD vertex.
+///
+/// @param[in] index  Index of the variable.
+/// @param[in] high_id  The id of the high vertex.
+/// @param[in] low_id  The id of the low vertex.
+///
+/// @returns The combined hash value of the argument numbers
+///          with all the bits mixed for the power-of-2 capacity.
+inline std::uint64_t HashSignature(int index, int high_id, int low_id) {
+  std::size_t seed = 0;
+  boost::hash_combine(seed, index);
+  boost::hash_combine(seed, high_id);
+  boost::hash_combine(seed, low_id);
+  std::uint64_t hash = seed;  // The SplitMix64 finalizer.
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111eb;
+  return hash ^ (hash >> 31);
+}
+
 /// A hash table for keeping BDD reduced.
 /// The management of the hash table is intrusive;
 /// that is, it relies on BDD vertices to provide necessary information.
@@ -396,33 +403,105 @@ int GetPrimeNumber(int n);
 /// This allows specialization of id calculations with attributed edges
 /// where simple calls for high/low ids may miss the edge information.
 ///
+/// The table uses open addressing with linear probing
+/// over a single contiguous array of entries (four per cache line).
+/// Each entry keeps a short tag of the key hash,
+/// so the vertices are dereferenced only upon tag matches.
+/// The entries of deleted vertices expire in place;
+/// these are reused by insertions and dropped upon rehashing.
+///
 /// @tparam T  The type of the main functional BDD vertex.
 template <class T>
 class UniqueTable {
-  /// Convenient aliases and customization points.
-  /// @{
-  using Bucket = std::forward_list<WeakIntrusivePtr<T>>;
-  using Table = std::vector<Bucket>;
-  /// @}
+  /// The table entry with the tag of the key hash.
+  struct Entry {
+    WeakIntrusivePtr<T> ptr;  ///< The vertex in the table.
+    std::uint32_t tag = kEmpty;  ///< The tag of the key or the entry state.
+  };
+  using Table = std::vector<Entry>;  ///< The capacity is a power of 2.
+
+  static const std::uint32_t kEmpty = 0;  ///< The never used entry.
+  static const std::uint32_t kDeleted = 1;  ///< The erased entry.
+  static const std::uint32_t kTagBit = 1u << 31;  ///< Distinct key tags.
 
  public:
   /// Constructor for small graphs.
   ///
   /// @param[in] init_capacity  The starting capacity for the table.
-  explicit UniqueTable(int init_capacity = 1000)
-      : capacity_(core::GetPrimeNumber(init_capacity)),
+  explicit UniqueTable(int init_capacity = 1024)
+      : capacity_(1),
         size_(0),
-        max_load_factor_(0.75),
-        table_(capacity_) {}
+        used_(0),
+        hits_(0),
+        misses_(0),
+        collisions_(0) {
+    while (capacity_ < init_capacity)
+      capacity_ *= 2;
+    table_ = Table(capacity_);
+  }
 
   /// @returns The current number of entries.
+  ///          The entries of deleted vertices are counted
+  ///          until purging or rehashing.
   int size() const { return size_; }
 
+  /// @returns The number of lookups that found existing vertices.
+  std::int64_t hits() const { return hits_; }
+
+  /// @returns The number of lookups that added new entries.
+  std::int64_t misses() const { return misses_; }
+
+  /// @returns The number of probes past the initial entry of lookups.
+  std::int64_t collisions() const { return collisions_; }
+
   /// Erases all entries.
   void clear() {
-    for (Bucket& chain : table_)
-      chain.clear();
+    for (Entry& entry : table_) {
+      entry.ptr.reset();
+      entry.tag = kEmpty;
+    }
     size_ = 0;
+    used_ = 0;
+  }
+
+  /// Removes expired entries from the table.
+  ///
+  /// @returns The number of live vertices in the table.
+  int Purge() noexcept {
+    Rehash();
+    return size_;
+  }
+
+  /// Removes expired entries
+  /// and collects all the vertices in the table.
+  ///
+  /// @returns Pointers to the vertices in the table.
+  std::vector<IntrusivePtr<T>> Collect() noexcept {
+    std::vector<IntrusivePtr<T>> vertices;
+    vertices.reserve(Purge());
+    for (const Entry& entry : table_) {
+      if (!entry.ptr.expired())
+        vertices.push_back(entry.ptr.lock());
+    }
+    return vertices;
+  }
+
+  /// Removes the entry of a vertex from the table.
+  ///
+  /// @param[in] vertex  The vertex with its entry in the table.
+  void Erase(const T& vertex) noexcept {
+    std::uint64_t hash = HashSignature(vertex.index(), get_high_id(vertex),
+                                       get_low_id(vertex));
+    for (int i = hash & (capacity_ - 1); table_[i].tag != kEmpty;
+         i = (i + 1) & (capacity_ - 1)) {
+      if (table_[i].ptr.get() == &vertex) {
+        table_[i].ptr.reset();
+        table_[i].tag = kDeleted;
+        --size_;
+        return;
+      }
+    }
+    assert(false && "The vertex is not in the table.");
   }
 
   /// Releases all the memory associated with managing this table with BDD.
@@ -444,107 +523,88 @@ class UniqueTable {
   /// Insertion operation may trigger resizing and rehashing.
   /// Rehashing eliminates expired weak pointers.
   ///
-  /// Collision resolution may also (opportunistically) remove
-  /// expired pointers in the chain.
-  ///
   /// @param[in] index  Index of the variable.
   /// @param[in] high_id  The id of the high vertex.
   /// @param[in] low_id  The id of the low vertex.
   ///
   /// @returns Reference to the weak pointer.
+  ///
+  /// @warning The reference is invalidated by the next insertion.
   WeakIntrusivePtr<T>& FindOrAdd(int index, int high_id, int low_id) noexcept {
-    if (size_ >= (max_load_factor_ * capacity_))
-      Rehash(GetNextCapacity(capacity_));
-
-    int bucket_number = Hash(index, high_id, low_id) % capacity_;
-    Bucket& chain = table_[bucket_number];
-    auto it_prev = chain.before_begin();  // Parent.
-    for (auto it_cur = chain.begin(), it_end = chain.end(); it_cur != it_end;) {
-      if (it_cur->expired()) {
-        it_cur = chain.erase_after(it_prev);
-        --size_;
-      } else {
-        T* vertex = it_cur->get();
+    if (used_ >= kMaxLoadFactor * capacity_)
+      Rehash();
+
+    std::uint64_t hash = HashSignature(index, high_id, low_id);
+    std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32) | kTagBit;
+    int free_entry = -1;  // The first expired entry to reuse.
+    int i = hash & (capacity_ - 1);
+    for (; table_[i].tag != kEmpty; i = (i + 1) & (capacity_ - 1)) {
+      Entry& entry = table_[i];
+      if (entry.tag == tag && !entry.ptr.expired()) {
+        T* vertex = entry.ptr.get();
         if (index == vertex->index() && high_id == get_high_id(*vertex) &&
             low_id == get_low_id(*vertex)) {
-          return *it_cur;
+          ++hits_;
+          return entry.ptr;
         }
-        it_prev = it_cur;
-        ++it_cur;
       }
+      if (free_entry < 0 && entry.ptr.expired())
+        free_entry = i;
+      ++collisions_;
     }
-    ++size_;
-    return *chain.emplace_after(it_prev);
+    ++misses_;
+    if (free_entry < 0) {
+      ++used_;
+      ++size_;
+    } else {
+      i = free_entry;
+      if (table_[i].tag == kDeleted)
+        ++size_;  // Otherwise, the expired entry is still counted.
+    }
+    table_[i].tag = tag;
+    return table_[i].ptr;
   }
 
  private:
-  /// Rehashes the table for the new number of buckets.
-  /// Upon rehashing the expired nodes are not moved to the new table.
-  ///
-  /// @param[in] new_capacity  The desired number of buckets.
-  void Rehash(int new_capacity) {
-    int new_size = 0;
+  /// The limit on the fraction of used entries including expired ones.
+  static constexpr double kMaxLoadFactor = 0.7;
+
+  /// Rehashes the live vertices into a new table.
+  /// The capacity grows
+  /// to keep the live entries under half of the maximum load.
+  void Rehash() noexcept {
+    int num_live = 0;
+    for (const Entry& entry : table_)
+      num_live += !entry.ptr.expired();
+    int new_capacity = capacity_;
+    while (num_live >= kMaxLoadFactor / 2 * new_capacity)
+      new_capacity *= 2;
     Table new_table(new_capacity);
-    for (Bucket& chain : table_) {
-      for (auto it_prev = chain.before_begin(), it_cur = chain.begin(),
-                it_end = chain.end();
-           it_cur != it_end;) {
-        if (it_cur->expired()) {
-          it_prev = it_cur;
-          ++it_cur;
-          continue;
-        }
-        ++new_size;
-        T* vertex = it_cur->get();
-        int bucket_number =
-            Hash(vertex->index(), get_high_id(*vertex), get_low_id(*vertex)) %
-            new_capacity;
-        Bucket& new_chain = new_table[bucket_number];
-        new_chain.splice_after(new_chain.before_begin(), chain, it_prev,
-                               ++it_cur);
-      }
+    for (Entry& entry : table_) {
+      if (entry.ptr.expired())
+        continue;
+      IntrusivePtr<T> vertex = entry.ptr.lock();
+      entry.ptr.reset();
+      int i = HashSignature(vertex->index(), get_high_id(*vertex),
+                            get_low_id(*vertex)) &
+              (new_capacity - 1);
+      while (new_table[i].tag != kEmpty)
+        i = (i + 1) & (new_capacity - 1);
+      new_table[i].ptr = vertex;
+      new_table[i].tag = entry.tag;
     }
     table_.swap(new_table);
-    size_ = new_size;
     capacity_ = new_capacity;
+    size_ = num_live;
+    used_ = num_live;
   }
 
-  /// Computes the hash value of the key.
-  ///
-  /// @param[in] index  Index of the variable.
-  /// @param[in] high_id  The id of the high vertex.
-  /// @param[in] low_id  The id of the low vertex.
-  ///
-  /// @returns The combined hash value of the argument numbers.
-  std::size_t Hash(int index, int high_id, int low_id) {
-    std::size_t seed = 0;
-    boost::hash_combine(seed, index);
-    boost::hash_combine(seed, high_id);
-    boost::hash_combine(seed, low_id);
-    return seed;
-  }
-
-  /// Computes a new capacity for resizing.
-  ///
-  /// @param[in] prev_capacity  The current capacity.
-  ///
-  /// @returns The new capacity scaled by the growth factor function.
-  ///
-  /// @note The growth tries to take into account the growth patterns of BDD.
-  int GetNextCapacity(int prev_capacity) {
-    const int kMaxScaleCapacity = 1e8;
-    int scale_power = 1;  // The default power after the max scale capacity.
-    if (prev_capacity < kMaxScaleCapacity) {
-      scale_power += std::log10(kMaxScaleCapacity / prev_capacity);
-    }
-    int growth_factor = std::pow(2, scale_power);
-    int new_capacity =  prev_capacity * growth_factor;
-    return core::GetPrimeNumber(new_capacity);
-  }
-
-  int capacity_;  ///< The total number of buckets in the table.
-  int size_;  ///< The total number of elements in the table.
-  double max_load_factor_;  ///< The limit on the avg. # of elements per bucket.
+  int capacity_;  ///< The total number of entries in the table.
+  int size_;  ///< The number of entries with vertices (maybe expired).
+  int used_;  ///< The number of entries ever used since rehashing.
+  std::int64_t hits_;  ///< The number of found vertices.
+  std::int64_t misses_;  ///< The number of added entries.
+  std::int64_t collisions_;  ///< The number of extra probes.
 
   /// A table of unique vertices is stored with weak pointers
   /// so that this hash table does not interfere
@@ -555,6 +615,8 @@ class UniqueTable {
 /// A hash table without collision resolution.
 /// Instead of resolving the collision,
 /// the existing value is purged and replaced by the new entry.
+/// The growth of the table can be limited
+/// to keep its memory within a budget.
 ///
 /// This hash table is designed to store computation results of BDD Apply.
 /// The implementation of the table
@@ -587,12 +649,33 @@ class CacheTable {
   /// @param[in] init_capacity
   explicit CacheTable(int init_capacity = 1000)
       : size_(0),
+        max_capacity_(0),
         max_load_factor_(0.75),
+        hits_(0),
+        misses_(0),
+        collisions_(0),
         table_(core::GetPrimeNumber(init_capacity)) {}
 
   /// @returns The number of entires in the table.
   int size() const { return size_; }
 
+  /// @returns The number of successful searches.
+  std::int64_t hits() const { return hits_; }
+
+  /// @returns The number of failed searches.
+  std::int64_t misses() const { return misses_; }
+
+  /// @returns The number of entries replaced by different keys.
+  std::int64_t collisions() const { return collisions_; }
+
+  /// Limits the growth of the table.
+  /// Once the limit is reached,
+  /// the table keeps its capacity and only replaces entries.
+  ///
+  /// @param[in] max_capacity  The maximum number of entries.
+  ///                          0 for no limit.
+  void max_capacity(int max_capacity) { max_capacity_ = max_capacity; }
+
   /// Removes all entries from the table.
   void clear() {
     for (value_type& entry : table_) {
@@ -628,8 +711,11 @@ class CacheTable {
   iterator find(const key_type& key) {
     int index = boost::hash_value(key) % table_.size();
     value_type& entry = table_[index];
-    if (!entry.second || entry.first != key)
+    if (!entry.second || entry.first != key) {
+      ++misses_;
       return table_.end();
+    }
+    ++hits_;
     return table_.begin() + index;
   }
 
@@ -647,13 +733,21 @@ class CacheTable {
   void emplace(const key_type& key, const mapped_type& value) {
     assert(value && "Empty computation results!");
 
-    if (size_ >= (max_load_factor_ * table_.size()))
-      Rehash(core::GetPrimeNumber(table_.size() * 2));
+    if (size_ >= (max_load_factor_ * table_.size()) &&
+        (!max_capacity_ || static_cast<int>(table_.size()) < max_capacity_)) {
+      int new_capacity = table_.size() * 2;
+      if (max_capacity_ && new_capacity > max_capacity_)
+        new_capacity = max_capacity_;
+      Rehash(core::GetPrimeNumber(new_capacity));
+    }
 
     int index = boost::hash_value(key) % table_.size();
     value_type& entry = table_[index];
-    if (!entry.second)
+    if (!entry.second) {
       ++size_;
+    } else if (entry.first != key) {
+      ++collisions_;
+    }
     entry.first = key;  // Key equality is unlikely for the use case.
     entry.second = value;  // Might be purging another value.
   }
@@ -680,38 +774,701 @@ class CacheTable {
   }
 
   int size_;  ///< The total number of elements in the table.
+  int max_capacity_;  ///< The limit on the growth of the table.
   double max_load_factor_;  ///< The limit on (size / capacity) ratio.
+  std::int64_t hits_;  ///< The number of found entries.
+  std::int64_t misses_;  ///< The number of failed searches.
+  std::int64_t collisions_;  ///< The number of replaced entries.
   std::vector<value_type> table_;  ///< The main container.
 };
 
+/// A lossy table of BDD computation results
+/// shared by the threads of the parallel Apply.
+/// The table does not grow during the computations;
+/// the existing entry is replaced upon a collision as in CacheTable.
+///
+/// Each entry is guarded by a sequence number (odd while being written),
+/// so the threads never wait for each other on the table:
+/// a busy entry is a miss for the readers
+/// and a skipped store for the writers,
+/// and the readers discard the entries changed during their reads.
+class SharedCacheTable : private boost::noncopyable {
+ public:
+  using key_type = std::pair<int, int>;  ///< Ordered argument ids.
+  /// Non-zero 32-bit representation of computation results.
+  using mapped_type = std::uint32_t;
+
+  SharedCacheTable() : capacity_(0), max_capacity_(0) {}
+
+  /// @returns The memory size of a single entry.
+  static constexpr std::size_t entry_size() { return sizeof(Entry); }
+
+  /// @returns The number of entries in the table.
+  int capacity() const { return capacity_; }
+
+  /// Limits the growth of the table.
+  ///
+  /// @param[in] max_capacity  The maximum number of entries.
+  ///                          0 for no limit.
+  void max_capacity(int max_capacity) { max_capacity_ = max_capacity; }
+
+  /// Removes all entries from the table.
+  ///
+  /// @warning Not thread-safe.
+  void clear() noexcept {
+    for (int i = 0; i < capacity_; ++i) {
+      table_[i].sequence.store(0, std::memory_order_relaxed);
+      table_[i].value.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /// Removes all entries and grows the table
+  /// to the power-of-2 capacity for the expected entries.
+  ///
+  /// @param[in] n  The number of expected entries.
+  ///
+  /// @post If n is 0, the memory is freed.
+  ///
+  /// @warning Not thread-safe.
+  void reserve(int n) noexcept {
+    if (n == 0) {
+      table_.reset();
+      capacity_ = 0;
+      return;
+    }
+    int capacity = 1;
+    while (capacity < n && (!max_capacity_ || 2 * capacity <= max_capacity_))
+      capacity *= 2;
+    if (capacity <= capacity_)
+      return clear();
+    table_.reset(new Entry[capacity]());
+    capacity_ = capacity;
+  }
+
+  /// Searches for the result of a computation.
+  ///
+  /// @param[in] key  Ordered unique ids of BDD Apply argument vertices.
+  ///
+  /// @returns The result of the computation.
+  /// @returns 0 if no consistent entry with the given key is found.
+  mapped_type find(const key_type& key) const noexcept {
+    std::uint64_t packed_key = Pack(key);
+    const Entry& entry = table_[Hash(packed_key) & (capacity_ - 1)];
+    std::uint32_t sequence = entry.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+      return 0;
+    if (entry.key.load(std::memory_order_relaxed) != packed_key)
+      return 0;
+    mapped_type value = entry.value.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence.load(std::memory_order_relaxed) != sequence)
+      return 0;
+    return value;
+  }
+
+  /// Stores the result of a computation if the entry is not busy.
+  ///
+  /// @param[in] key  Ordered unique ids of BDD Apply argument vertices.
+  /// @param[in] value  Non-zero result of BDD Apply computations.
+  void emplace(const key_type& key, mapped_type value) noexcept {
+    assert(value && "Empty computation results!");
+    std::uint64_t packed_key = Pack(key);
+    Entry& entry = table_[Hash(packed_key) & (capacity_ - 1)];
+    std::uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) ||
+        !entry.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                                std::memory_order_relaxed))
+      return;
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.key.store(packed_key, std::memory_order_relaxed);
+    entry.value.store(value, std::memory_order_relaxed);
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+ private:
+  /// The table entry with its sequence number.
+  struct Entry {
+    std::atomic<std::uint32_t> sequence;  ///< The odd number while writing.
+    std::atomic<mapped_type> value;  ///< The result or 0 for no entry.
+    std::atomic<std::uint64_t> key;  ///< The packed argument ids.
+  };
+
+  /// @returns The argument ids packed into a single number.
+  static std::uint64_t Pack(const key_type& key) {
+    return static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.first))
+               << 32 |
+           static_cast<std::uint32_t>(key.second);
+  }
+
+  /// @returns The hash value of the packed key with all the bits mixed.
+  static std::uint64_t Hash(std::uint64_t key) {
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111eb;
+    return key ^ (key >> 31);
+  }
+
+  int capacity_;  ///< The power-of-2 number of entries.
+  int max_capacity_;  ///< The limit on the growth of the table.
+  std::unique_ptr<Entry[]> table_;  ///< The entries.
+};
+
+/// Representation of non-terminal if-then-else vertices in BDD graphs.
+/// The vertices live in the arena of their BDD
+/// and refer to their branches with 32-bit handles into the arena.
+/// The vertices are not reference counted
+/// (see IteArena for the management).
+///
+/// This class provides one attributed complement edge.
+/// The attributed edge applies to the low/false/0 branch of the vertex.
+/// However, there is no logic to check
+/// if the complement edge manipulations are valid.
+/// Consistency is the responsibility of BDD algorithms and users.
+class Ite {
+  friend class IteArena;  // Management of the unique table and liveness.
+
+ public:
+  /// Handle of a vertex in the arena of its BDD.
+  /// The handle is also the identifier of the function graph
+  /// rooted by the vertex.
+  using Handle = std::uint32_t;
+
+  static const Handle kNull = 0;  ///< The handle of no vertex.
+  static const Handle kOne = 1;  ///< The handle of the terminal True.
+  static const int kMaxOrder = (1 << 27) - 1;  ///< The limit of the bits.
+
+  /// Constructs a free arena slot.
+  Ite()
+      : order_(0),
+        complement_edge_(false),
+        module_(false),
+        coherent_(false),
+        mark_(false),
+        live_(false) {}
+
+  /// @returns The index of this vertex.
+  int index() const { return index_; }
+
+  /// @returns The order of the vertex.
+  int order() const {
+    assert(order_ > 0);
+    return order_;
+  }
+
+  /// Sets the new order of the vertex variable upon variable reordering.
+  ///
+  /// @param[in] order  The new positive order of the variable.
+  void order(int order) {
+    assert(order > 0 && order <= kMaxOrder);
+    order_ = order;
+  }
+
+  /// @returns true if this vertex represents a module gate.
+  bool module() const { return module_; }
+
+  /// Sets this vertex for representation of a module.
+  void module(bool flag) { module_ = flag; }
+
+  /// @returns true if the vertex represents a coherent module.
+  bool coherent() const { return coherent_; }
+
+  /// Sets the flag for coherent modules.
+  ///
+  /// @param[in] flag  true for coherent modules.
+  void coherent(bool flag) {
+    assert(!(coherent_ && !flag) && "Inverting existing coherence.");
+    coherent_ = flag;
+  }
+
+  /// @returns (1/True/then/left) branch if-then-else vertex.
+  Handle high() const { return high_; }
+
+  /// @returns (0/False/else/right) branch vertex.
+  Handle low() const { return low_; }
+
+  /// @returns true if the low edge is complement.
+  bool complement_edge() const { return complement_edge_; }
+
+  /// Replaces the variable and branches of this vertex in place.
+  /// This is a facility for variable reordering,
+  /// which must preserve the function represented by the vertex.
+  ///
+  /// @param[in] index  Index of the new variable.
+  /// @param[in] order  Order of the new variable.
+  /// @param[in] high  The new high vertex.
+  /// @param[in] low  The new low vertex.
+  /// @param[in] complement_edge  Interpretation of the low vertex.
+  /// @param[in] module  The indication of a module variable.
+  /// @param[in] coherent  The indication of a coherent module.
+  ///
+  /// @warning The vertex must be out of the unique table for the change.
+  void Reset(int index, int order, Handle high, Handle low,
+             bool complement_edge, bool module, bool coherent) {
+    assert(index > 0 && "Only positive indices are expected.");
+    index_ = index;
+    this->order(order);
+    high_ = high;
+    low_ = low;
+    complement_edge_ = complement_edge;
+    module_ = module;
+    coherent_ = coherent;
+  }
+
+  /// @returns The mark of this vertex.
+  bool mark() const { return mark_; }
+
+  /// Marks this vertex.
+  ///
+  /// @param[in] flag  A flag with the meaning for the user of marks.
+  void mark(bool flag) { mark_ = flag; }
+
+ private:
+  Handle high_ = kNull;  ///< 1 (True/then) branch in the Shannon decomposition.
+  Handle low_ = kNull;  ///< O (False/else) branch in the Shannon decomposition.
+  /// The next vertex in the unique table bucket or in the free list.
+  Handle next_ = kNull;
+  int index_ = 0;  ///< Index of the variable or 0 for free arena slots.
+  std::uint32_t order_ : 27;  ///< Order of the variable.
+  std::uint32_t complement_edge_ : 1;  ///< Flag for complement edge.
+  std::uint32_t module_ : 1;  ///< Mark for module variables.
+  std::uint32_t coherent_ : 1;  ///< Mark for coherence.
+  std::uint32_t mark_ : 1;  ///< Traversal mark.
+  std::uint32_t live_ : 1;  ///< Reachability mark for garbage collection.
+};
+
+/// The storage of BDD if-then-else vertices
+/// in an arena addressed with 32-bit handles
+/// together with the unique table to keep the BDD reduced.
+///
+/// The arena grows by fixed-size blocks of contiguous vertices,
+/// so references to the vertices are not invalidated by the growth.
+/// The unique table is a power-of-2 array of buckets
+/// chained through the vertices themselves.
+///
+/// The vertices are not reference counted.
+/// The owner BDD marks the vertices reachable from its live functions
+/// at safe points,
+/// and the unmarked vertices are swept into a free list for recycling
+/// (mark-and-sweep garbage collection).
+/// Sweeping recycles handles,
+/// so all the results memoized by handles must be discarded.
+///
+/// The arena can be shared by threads adding vertices concurrently
+/// (FindOrAddShared) between the safe points.
+/// The unique table is then guarded by stripes of locks,
+/// and the vertices are immutable once added.
+class IteArena : private boost::noncopyable {
+ public:
+  using Handle = Ite::Handle;  ///< Handles of the vertices.
+
+  IteArena()
+      : num_slots_(Ite::kOne + 1),
+        size_(0),
+        free_(Ite::kNull),
+        hits_(0),
+        misses_(0),
+        collisions_(0),
+        buckets_(1024, Ite::kNull) {}
+
+  /// @param[in] vertex  The handle of a non-terminal vertex in the arena.
+  ///
+  /// @returns The if-then-else vertex.
+  /// @{
+  Ite& operator[](Handle vertex) {
+    assert(vertex > Ite::kOne && vertex < num_slots_ && "Invalid handle.");
+    return blocks_[vertex >> kBlockBits][vertex & (kBlockSize - 1)];
+  }
+  const Ite& operator[](Handle vertex) const {
+    assert(vertex > Ite::kOne && vertex < num_slots_ && "Invalid handle.");
+    return blocks_[vertex >> kBlockBits][vertex & (kBlockSize - 1)];
+  }
+  /// @}
+
+  /// @returns The number of vertices in the arena.
+  ///          Unreachable vertices are counted until sweeping.
+  int size() const { return size_; }
+
+  /// @returns The upper bound of the vertex handles in the arena.
+  int capacity() const { return num_slots_; }
+
+  /// @returns The number of lookups that found existing vertices.
+  std::int64_t hits() const { return hits_ + Sum(&Stripe::hits); }
+
+  /// @returns The number of lookups that added new vertices.
+  std::int64_t misses() const { return misses_ + Sum(&Stripe::misses); }
+
+  /// @returns The number of chained vertices visited past the first.
+  std::int64_t collisions() const {
+    return collisions_ + Sum(&Stripe::collisions);
+  }
+
+  /// Finds an existing vertex or adds a new vertex into the unique table.
+  ///
+  /// @param[in] index  Positive index of the variable.
+  /// @param[in] high  The high vertex.
+  /// @param[in] low  The low vertex.
+  /// @param[in] complement_edge  Interpretation of the low vertex.
+  /// @param[in] order  The order for the vertex variable.
+  /// @param[in] module  The indication of a module variable.
+  /// @param[in] coherent  The indication of a coherent module.
+  ///
+  /// @returns The handle of the vertex
+  ///          and the indication of the newly added vertex.
+  std::pair<Handle, bool> FindOrAdd(int index, Handle high, Handle low,
+                                    bool complement_edge, int order,
+                                    bool module, bool coherent) noexcept {
+    Handle* bucket =
+        &buckets_[Hash(index, high, low, complement_edge) &
+                  (buckets_.size() - 1)];
+    if (Handle vertex =
+            Find(*bucket, index, high, low, complement_edge, &collisions_)) {
+      ++hits_;
+      return {vertex, false};
+    }
+    ++misses_;
+    Handle vertex = Allocate();
+    Link(bucket, vertex, index, order, high, low, complement_edge, module,
+         coherent);
+    if (size_ > static_cast<int>(buckets_.size()))
+      Rehash(2 * buckets_.size());
+    return {vertex, true};
+  }
+
+  /// Prepares the arena to be shared by threads.
+  ///
+  /// @post FindOrAddShared is safe to call concurrently.
+  void Share() noexcept {
+    if (stripes_)
+      return;
+    assert(buckets_.size() >= kNumStripes && "Stripes share buckets.");
+    stripes_.reset(new Stripe[kNumStripes]);
+    // The blocks must not move upon the growth in other threads.
+    blocks_.reserve((1u << 31) >> kBlockBits);
+  }
+
+  /// The thread-safe version of FindOrAdd
+  /// for the threads sharing the arena.
+  /// The concurrent calls must not be mixed
+  /// with any other modification of the arena.
+  ///
+  /// @copydetails FindOrAdd
+  ///
+  /// @pre The arena is shared.
+  std::pair<Handle, bool> FindOrAddShared(int index, Handle high, Handle low,
+                                          bool complement_edge, int order,
+                                          bool module,
+                                          bool coherent) noexcept {
+    assert(stripes_ && "The arena is not shared.");
+    std::uint64_t hash = Hash(index, high, low, complement_edge);
+    // The stripe bits are the lowest bits of all the buckets in the stripe.
+    Stripe& stripe = stripes_[hash & (kNumStripes - 1)];
+    std::unique_lock<std::mutex> lock(stripe.mutex);
+    Handle* bucket = &buckets_[hash & (buckets_.size() - 1)];
+    if (Handle vertex = Find(*bucket, index, high, low, complement_edge,
+                             &stripe.collisions)) {
+      ++stripe.hits;
+      return {vertex, false};
+    }
+    ++stripe.misses;
+    if (stripe.reserve.empty()) {
+      std::lock_guard<std::mutex> allocation(allocation_mutex_);
+      for (int i = 0; i < kReserveSize; ++i)
+        stripe.reserve.push_back(TakeSlot());
+    }
+    Handle vertex = stripe.reserve.back();
+    stripe.reserve.pop_back();
+    Link(bucket, vertex, index, order, high, low, complement_edge, module,
+         coherent);
+    bool grow = ++size_ > static_cast<int>(buckets_.size());
+    lock.unlock();
+    if (grow) {  // All the stripes are locked in order to rehash.
+      for (int i = 0; i < kNumStripes; ++i)
+        stripes_[i].mutex.lock();
+      if (size_ > static_cast<int>(buckets_.size()))
+        Rehash(2 * buckets_.size());
+      for (int i = 0; i < kNumStripes; ++i)
+        stripes_[i].mutex.unlock();
+    }
+    return {vertex, true};
+  }
+
+  /// Removes a live vertex from the unique table
+  /// to change the vertex in place.
+  ///
+  /// @param[in] vertex  The vertex in the unique table.
+  void Erase(Handle vertex) noexcept {
+    const Ite& ite = (*this)[vertex];
+    Handle* it =
+        &buckets_[Hash(ite.index_, ite.high_, ite.low_, ite.complement_edge_) &
+                  (buckets_.size() - 1)];
+    while (*it != vertex) {
+      assert(*it != Ite::kNull && "The vertex is not in the table.");
+      it = &(*this)[*it].next_;
+    }
+    *it = ite.next_;
+  }
+
+  /// Puts a changed vertex back into the unique table.
+  ///
+  /// @param[in] vertex  The vertex out of the unique table.
+  ///
+  /// @pre The table has no other vertex with the same signature.
+  void Insert(Handle vertex) noexcept {
+    Ite& ite = (*this)[vertex];
+    Handle* bucket =
+        &buckets_[Hash(ite.index_, ite.high_, ite.low_, ite.complement_edge_) &
+                  (buckets_.size() - 1)];
+#ifndef NDEBUG
+    for (Handle it = *bucket; it != Ite::kNull; it = (*this)[it].next_) {
+      const Ite& other = (*this)[it];
+      assert(!(other.index_ == ite.index_ && other.high_ == ite.high_ &&
+               other.low_ == ite.low_ &&
+               other.complement_edge_ == ite.complement_edge_) &&
+             "Non-canonical vertex.");
+    }
+#endif
+    ite.next_ = *bucket;
+    *bucket = vertex;
+  }
+
+  /// Removes a vertex from the unique table
+  /// and recycles its slot in the arena.
+  ///
+  /// @param[in] vertex  The unreferenced vertex in the unique table.
+  void Free(Handle vertex) noexcept {
+    Erase(vertex);
+    Recycle(vertex);
+  }
+
+  /// Marks the vertices reachable from a root vertex as live.
+  ///
+  /// @param[in] root  The root vertex of a function graph.
+  void Mark(Handle root) noexcept {
+    std::vector<Handle> stack = {root};
+    while (!stack.empty()) {
+      Handle vertex = stack.back();
+      stack.pop_back();
+      if (vertex == Ite::kOne)
+        continue;
+      Ite& ite = (*this)[vertex];
+      if (ite.live_)
+        continue;
+      ite.live_ = true;
+      stack.push_back(ite.high_);
+      stack.push_back(ite.low_);
+    }
+  }
+
+  /// Recycles the vertices not marked as live
+  /// and clears the marks of the rest.
+  /// The unique table is rebuilt with the live vertices only.
+  ///
+  /// @returns The number of recycled vertices.
+  int Sweep() noexcept {
+    int num_dead = 0;
+    std::fill(buckets_.begin(), buckets_.end(), Ite::kNull);
+    for (Handle vertex = Ite::kOne + 1, end = num_slots_; vertex < end;
+         ++vertex) {
+      Ite& ite = (*this)[vertex];
+      if (!ite.index_)
+        continue;  // Already free.
+      if (!ite.live_) {
+        Recycle(vertex);
+        ++num_dead;
+        continue;
+      }
+      ite.live_ = false;
+      if (!buckets_.empty())
+        Insert(vertex);
+    }
+    return num_dead;
+  }
+
+  /// Calls a function for all the vertices in the arena.
+  ///
+  /// @tparam F  The function type accepting the handle and the vertex.
+  ///
+  /// @param[in] visit  The function to call for every vertex.
+  template <class F>
+  void ForEach(F&& visit) noexcept {
+    for (Handle vertex = Ite::kOne + 1, end = num_slots_; vertex < end;
+         ++vertex) {
+      Ite& ite = (*this)[vertex];
+      if (ite.index_)
+        visit(vertex, ite);
+    }
+  }
+
+  /// Releases the memory of the unique table.
+  ///
+  /// @post No more vertices can be added or changed.
+  void Release() noexcept {
+    buckets_ = std::vector<Handle>();
+    stripes_.reset();
+  }
+
+ private:
+  static const int kBlockBits = 14;  ///< The number of vertices per block.
+  static const int kBlockSize = 1 << kBlockBits;  ///< The block allocation.
+  static const int kNumStripes = 1024;  ///< The locks of the shared table.
+  static const int kReserveSize = 64;  ///< The slots taken by a stripe.
+
+  /// The lock of the buckets with the same lowest bits
+  /// and the resources of the vertices added under the lock.
+  struct Stripe {
+    std::mutex mutex;  ///< The lock of the buckets.
+    std::vector<Handle> reserve;  ///< The free slots for new vertices.
+    std::int64_t hits = 0;  ///< The number of found vertices.
+    std::int64_t misses = 0;  ///< The number of added vertices.
+    std::int64_t collisions = 0;  ///< The number of extra visits.
+  };
+
+  /// @returns The hash value of a vertex signature.
+  static std::uint64_t Hash(int index, Handle high, Handle low,
+                            bool complement_edge) {
+    int low_id = complement_edge ? -static_cast<int>(low) : low;
+    return HashSignature(index, high, low_id);
+  }
+
+  /// Finds a vertex with the signature in a chain of the unique table.
+  ///
+  /// @param[in] head  The first vertex in the chain.
+  /// @param[in] index  Positive index of the variable.
+  /// @param[in] high  The high vertex.
+  /// @param[in] low  The low vertex.
+  /// @param[in] complement_edge  Interpretation of the low vertex.
+  /// @param[in,out] collisions  The counter of the visits past the first.
+  ///
+  /// @returns The vertex in the chain or Ite::kNull.
+  Handle Find(Handle head, int index, Handle high, Handle low,
+              bool complement_edge, std::int64_t* collisions) const noexcept {
+    for (Handle it = head; it != Ite::kNull; it = (*this)[it].next_) {
+      const Ite& ite = (*this)[it];
+      if (ite.index_ == index && ite.high_ == high && ite.low_ == low &&
+          ite.complement_edge_ == complement_edge)
+        return it;
+      ++*collisions;
+    }
+    return Ite::kNull;
+  }
+
+  /// Initializes a vertex in a free slot
+  /// and puts it at the head of a unique table chain.
+  void Link(Handle* bucket, Handle vertex, int index, int order, Handle high,
+            Handle low, bool complement_edge, bool module,
+            bool coherent) noexcept {
+    Ite& ite = (*this)[vertex];
+    ite.Reset(index, order, high, low, complement_edge, module, coherent);
+    ite.next_ = *bucket;
+    *bucket = vertex;
+  }
+
+  /// @returns The sum of a counter over the stripes.
+  std::int64_t Sum(std::int64_t Stripe::*counter) const {
+    std::int64_t sum = 0;
+    if (stripes_) {
+      for (int i = 0; i < kNumStripes; ++i)
+        sum += stripes_[i].*counter;
+    }
+    return sum;
+  }
+
+  /// @returns A free slot for a new vertex.
+  Handle Allocate() noexcept {
+    ++size_;
+    return TakeSlot();
+  }
+
+  /// @returns A slot from the free list or a new slot.
+  Handle TakeSlot() noexcept {
+    if (free_ != Ite::kNull) {
+      Handle vertex = free_;
+      free_ = (*this)[vertex].next_;
+      return vertex;
+    }
+    Handle vertex = num_slots_;
+    assert(vertex < (1u << 31) && "Handles must fit in positive ids.");
+    if ((vertex >> kBlockBits) == blocks_.size())
+      blocks_.emplace_back(new Ite[kBlockSize]);
+    num_slots_ = vertex + 1;  // The new block is ready.
+    return vertex;
+  }
+
+  /// Puts the slot of a vertex into the free list.
+  ///
+  /// @param[in] vertex  The vertex out of the unique table.
+  void Recycle(Handle vertex) noexcept {
+    Ite& ite = (*this)[vertex];
+    ite = Ite();
+    ite.next_ = free_;
+    free_ = vertex;
+    --size_;
+  }
+
+  /// Redistributes the vertices in the chains among new buckets.
+  ///
+  /// @param[in] num_buckets  The new power-of-2 number of buckets.
+  void Rehash(int num_buckets) noexcept {
+    std::vector<Handle> buckets(num_buckets, Ite::kNull);
+    buckets_.swap(buckets);
+    for (Handle head : buckets) {
+      for (Handle vertex = head; vertex != Ite::kNull;) {
+        Handle next = (*this)[vertex].next_;
+        Insert(vertex);
+        vertex = next;
+      }
+    }
+  }
+
+  std::atomic<Handle> num_slots_;  ///< The number of ever used handles.
+  std::atomic<int> size_;  ///< The number of vertices.
+  Handle free_;  ///< The head of the free list.
+  std::int64_t hits_;  ///< The number of found vertices.
+  std::int64_t misses_;  ///< The number of added vertices.
+  std::int64_t collisions_;  ///< The number of extra visits.
+  std::vector<std::unique_ptr<Ite[]>> blocks_;  ///< The arena of vertices.
+  std::vector<Handle> buckets_;  ///< The heads of the unique table chains.
+  std::unique_ptr<Stripe[]> stripes_;  ///< The locks for the shared arena.
+  std::mutex allocation_mutex_;  ///< The lock of the slots for the stripes.
+};
+
 class Zbdd;  // For analysis purposes.
+class TaskPool;  // For the parallel Apply.
 
 /// Analysis of PDAGs with Binary Decision Diagrams.
 /// This binary decision diagram data structure
 /// represents Reduced Ordered BDD with attributed edges.
 ///
+/// The vertices are kept in the arena of the BDD
+/// and reclaimed with garbage collection at safe points
+/// between the conversions of PDAG gates and Apply operations.
+///
+/// If requested by the settings,
+/// the Apply operations split the recursion on the high and low branches
+/// into the tasks for threads down to the fork depth.
+/// The threads share the arena and the lossy computation tables
+/// until the next safe point.
+///
 /// @note The low/else edge is chosen to have the attribute for an ITE vertex.
 ///       There is only one terminal vertex of value 1/True.
 class Bdd : private boost::noncopyable {
  public:
-  using VertexPtr = IntrusivePtr<Vertex<Ite>>;  ///< BDD vertex base.
-  using TerminalPtr = IntrusivePtr<Terminal<Ite>>;  ///< Terminal vertices.
+  using Handle = Ite::Handle;  ///< The vertex handles in the arena.
 
   /// Holder of computation resultant functions and gate representations.
   struct Function {
     bool complement;  ///< The interpretation of the function.
-    VertexPtr vertex;  ///< The root vertex of the BDD function graph.
+    Handle vertex;  ///< The root vertex of the BDD function graph.
 
     /// @returns true if the function is initialized.
-    explicit operator bool() const { return vertex != nullptr; }
+    explicit operator bool() const { return vertex != Ite::kNull; }
 
-    /// Clears the function's root vertex pointer.
-    void reset() { vertex = nullptr; }
+    /// Clears the function's root vertex handle.
+    void reset() { vertex = Ite::kNull; }
 
     /// Swaps with another function.
     void swap(Function& other) noexcept {
       std::swap(complement, other.complement);
-      vertex.swap(other.vertex);
+      std::swap(vertex, other.vertex);
     }
   };
 
@@ -726,11 +1483,16 @@ class Bdd : private boost::noncopyable {
     /// @param[in] complement  Interpretation of the BDD vertex.
     ///
     /// @returns The consensus BDD function.
-    Function operator()(Bdd* bdd, const ItePtr& ite, bool complement) noexcept {
+    Function operator()(Bdd* bdd, Handle ite, bool complement) noexcept {
       return bdd->CalculateConsensus(ite, complement);
     }
   };
 
+  /// @param[in] vertex  The handle of a vertex.
+  ///
+  /// @returns true if the vertex is the terminal vertex.
+  static bool terminal(Handle vertex) { return vertex == Ite::kOne; }
+
   /// Constructor with the analysis target.
   /// Reduced Ordered BDD is produced from a PDAG.
   ///
@@ -756,6 +1518,13 @@ class Bdd : private boost::noncopyable {
     return index_to_order_;
   }
 
+  /// @param[in] vertex  The handle of a non-terminal vertex.
+  ///
+  /// @returns The if-then-else vertex in the arena.
+  ///
+  /// @note The reference is not invalidated by the addition of vertices.
+  const Ite& ite(Handle vertex) const { return arena_[vertex]; }
+
   /// @returns true if the BDD has been constructed from a coherent PDAG.
   bool coherent() const { return coherent_; }
 
@@ -769,6 +1538,21 @@ class Bdd : private boost::noncopyable {
   ///          this function will not help with the mess.
   void ClearMarks(bool mark) { ClearMarks(root_.vertex, mark); }
 
+  /// Reorders the variables with sifting [Rudell 1993]
+  /// to reduce the number of vertices in the BDD.
+  /// Each variable is moved through all the positions
+  /// with swaps of adjacent levels,
+  /// and it is put into the position with the smallest BDD.
+  /// Vertices keep their handles and functions,
+  /// so all the functions held outside of the unique table
+  /// (including modules) stay valid.
+  ///
+  /// @pre The unique table is not released (no analysis is done).
+  /// @pre No Apply computations are in progress.
+  ///
+  /// @post Computation tables are cleared.
+  void Reorder() noexcept;
+
   /// Runs the Qualitative analysis
   /// with the representation of a PDAG as ROBDD.
   void Analyze() noexcept;
@@ -782,9 +1566,17 @@ class Bdd : private boost::noncopyable {
   }
 
  private:
-  using IteWeakPtr = WeakIntrusivePtr<Ite>;  ///< Pointer in containers.
   using ComputeTable = CacheTable<Function>;  ///< Computation results.
 
+  /// Vertices of a single variable for variable reordering.
+  struct Level {
+    int index;  ///< The index of the variable.
+    int order;  ///< The current order of the variable.
+    bool module;  ///< The indication of a module variable.
+    bool coherent;  ///< The indication of a coherent module.
+    std::vector<Handle> vertices;  ///< The live vertices of the variable.
+  };
+
   /// Finds or adds a unique if-then-else vertex in BDD.
   /// All vertices in the BDD must be created with this functions.
   /// Otherwise, the BDD may not be reduced.
@@ -794,13 +1586,13 @@ class Bdd : private boost::noncopyable {
   /// @param[in] low  The low vertex.
   /// @param[in] complement_edge  Interpretation of the low vertex.
   /// @param[in] order The order for the vertex variable.
+  /// @param[in] module  The indication of a module variable.
+  /// @param[in] coherent  The indication of a coherent module.
   ///
   /// @returns If-then-else node with the given parameters.
-  ///
-  /// @pre Non-expired pointers in the unique table are
-  ///      either in the BDD or in the computation table.
-  ItePtr FindOrAddVertex(int index, const VertexPtr& high, const VertexPtr& low,
-                         bool complement_edge, int order) noexcept;
+  Handle FindOrAddVertex(int index, Handle high, Handle low,
+                         bool complement_edge, int order, bool module = false,
+                         bool coherent = false) noexcept;
 
   /// Finds or adds a replacement for an existing node
   /// or a new node based on an existing node.
@@ -813,8 +1605,8 @@ class Bdd : private boost::noncopyable {
   /// @returns Ite for a replacement.
   ///
   /// @warning This function is not aware of reduction rules.
-  ItePtr FindOrAddVertex(const ItePtr& ite, const VertexPtr& high,
-                         const VertexPtr& low, bool complement_edge) noexcept;
+  Handle FindOrAddVertex(const Ite& ite, Handle high, Handle low,
+                         bool complement_edge) noexcept;
 
   /// Find or adds a BDD ITE vertex using information from gates.
   ///
@@ -828,22 +1620,17 @@ class Bdd : private boost::noncopyable {
   /// @pre The gate is a module.
   ///
   /// @warning This function is not aware of reduction rules.
-  ItePtr FindOrAddVertex(const Gate& gate, const VertexPtr& high,
-                         const VertexPtr& low, bool complement_edge) noexcept;
+  Handle FindOrAddVertex(const Gate& gate, Handle high, Handle low,
+                         bool complement_edge) noexcept;
 
   /// Converts all gates in the PDAG
   /// into function BDD graphs.
   /// Registers processed gates.
   ///
   /// @param[in] gate  The root or current parent gate of the graph.
-  /// @param[in,out] gates  Processed gates with use counts.
   ///
   /// @returns The BDD function representing the gate.
-  ///
-  /// @pre The memoization container is not used outside of this function.
-  Function ConvertGraph(
-      const Gate& gate,
-      std::unordered_map<int, std::pair<Function, int>>* gates) noexcept;
+  Function ConvertGraph(const Gate& gate) noexcept;
 
   /// Computes minimum and maximum ids for keys in computation tables.
   ///
@@ -856,10 +1643,9 @@ class Bdd : private boost::noncopyable {
   ///
   /// @pre The arguments are not be the same function.
   ///      Equal ID functions are handled by the reduction.
-  /// @pre Even though the arguments are not ItePtr type,
-  ///      they are if-then-else vertices.
-  std::pair<int, int> GetMinMaxId(const VertexPtr& arg_one,
-                                  const VertexPtr& arg_two, bool complement_one,
+  /// @pre The arguments are if-then-else vertices.
+  std::pair<int, int> GetMinMaxId(Handle arg_one, Handle arg_two,
+                                  bool complement_one,
                                   bool complement_two) noexcept;
 
   /// Applies Boolean operation to BDD graphs.
@@ -877,26 +1663,88 @@ class Bdd : private boost::noncopyable {
   ///
   /// @note The order of arguments does not matter for two variable operators.
   template <Operator Type>
-  Function Apply(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                 bool complement_one, bool complement_two) noexcept;
+  Function Apply(Handle arg_one, Handle arg_two, bool complement_one,
+                 bool complement_two) noexcept;
 
   /// Applies Boolean operation to BDD ITE graphs.
   ///
   /// @tparam Type  The operator enum.
   ///
-  /// @param[in] ite_one  First argument function graph.
-  /// @param[in] ite_two  Second argument function graph.
+  /// @param[in] ite_one  First argument if-then-else vertex.
+  /// @param[in] ite_two  Second argument if-then-else vertex.
   /// @param[in] complement_one  Interpretation of arg_one as complement.
   /// @param[in] complement_two  Interpretation of arg_two as complement.
   ///
   /// @returns The BDD function as a result of operation.
   template <Operator Type>
-  Function Apply(ItePtr ite_one, ItePtr ite_two, bool complement_one,
-                 bool complement_two) noexcept;
+  Function ApplyIte(Handle ite_one, Handle ite_two, bool complement_one,
+                    bool complement_two) noexcept;
+
+  /// Applies Boolean operation to BDD graphs
+  /// with the computations shared among threads.
+  ///
+  /// @tparam Type  The operator enum.
+  ///
+  /// @param[in] arg_one  First argument function graph.
+  /// @param[in] arg_two  Second argument function graph.
+  /// @param[in] complement_one  Interpretation of arg_one as complement.
+  /// @param[in] complement_two  Interpretation of arg_two as complement.
+  /// @param[in] depth  The depth of the operation in the recursion.
+  ///
+  /// @returns The BDD function as a result of operation.
+  ///
+  /// @pre The arena is shared among the threads of the pool.
+  template <Operator Type>
+  Function ApplyShared(Handle arg_one, Handle arg_two, bool complement_one,
+                       bool complement_two, int depth) noexcept;
+
+  /// Applies Boolean operation to BDD ITE graphs
+  /// with the computations shared among threads.
+  /// The high branch is forked into a task above the fork depth.
+  ///
+  /// @tparam Type  The operator enum.
+  ///
+  /// @param[in] ite_one  First argument if-then-else vertex.
+  /// @param[in] ite_two  Second argument if-then-else vertex.
+  /// @param[in] complement_one  Interpretation of arg_one as complement.
+  /// @param[in] complement_two  Interpretation of arg_two as complement.
+  /// @param[in] depth  The depth of the operation in the recursion.
+  ///
+  /// @returns The BDD function as a result of operation.
+  template <Operator Type>
+  Function ApplyIteShared(Handle ite_one, Handle ite_two, bool complement_one,
+                          bool complement_two, int depth) noexcept;
+
+  /// Reduces Boolean operations with terminal or equal arguments.
+  ///
+  /// @tparam Type  The operator enum.
+  ///
+  /// @param[in] arg_one  First argument function graph.
+  /// @param[in] arg_two  Second argument function graph.
+  /// @param[in] complement_one  Interpretation of arg_one as complement.
+  /// @param[in] complement_two  Interpretation of arg_two as complement.
+  /// @param[out] result  The BDD function as a result of the reduction.
+  ///
+  /// @returns true if the operation is reduced.
+  template <Operator Type>
+  static bool Reduce(Handle arg_one, Handle arg_two, bool complement_one,
+                     bool complement_two, Function* result) noexcept;
+
+  /// @returns The function packed into a non-zero 32-bit number
+  ///          for the shared computation tables.
+  static std::uint32_t Pack(const Function& function) {
+    return function.vertex << 1 | function.complement;
+  }
+
+  /// @returns The function unpacked from the shared computation tables.
+  static Function Unpack(std::uint32_t value) {
+    return {static_cast<bool>(value & 1), value >> 1};
+  }
 
   /// Applies Boolean operation to BDD graphs.
   /// This is a convenience function
   /// if the operator type cannot be determined at compile time.
+  /// The operation is parallel if requested by the settings.
   ///
   /// @param[in] type  The operator or type of the gate.
   /// @param[in] arg_one  First argument function graph.
@@ -906,20 +1754,81 @@ class Bdd : private boost::noncopyable {
   ///
   /// @returns The BDD function as a result of operation.
   ///
-  /// @pre The operator is either AND or OR.
+  /// @pre The operator is AND, OR, or XOR.
   ///
   /// @note The order of arguments does not matter for two variable operators.
-  Function Apply(Operator type,
-                 const VertexPtr& arg_one, const VertexPtr& arg_two,
+  Function Apply(Operator type, Handle arg_one, Handle arg_two,
                  bool complement_one, bool complement_two) noexcept;
 
+  /// Constructs the threshold function of a K/N gate
+  /// with the dynamic programming over the ordered arguments
+  /// instead of the expansion into AND/OR formulas.
+  ///
+  /// @param[in] vote_number  The minimum number of true arguments (K).
+  /// @param[in,out] args  The argument functions to be sorted by order.
+  ///
+  /// @returns The BDD function of the K/N gate.
+  ///
+  /// @pre 1 < K < N.
+  Function ApplyVote(int vote_number, std::vector<Function>* args) noexcept;
+
   /// Calculates consensus of high and low of an if-then-else BDD vertex.
   ///
   /// @param[in] ite  The BDD vertex with the input.
   /// @param[in] complement  Interpretation of the BDD vertex.
   ///
   /// @returns The consensus BDD function.
-  Function CalculateConsensus(const ItePtr& ite, bool complement) noexcept;
+  Function CalculateConsensus(Handle ite, bool complement) noexcept;
+
+  /// Calls a function for every function held by the BDD.
+  /// These are the roots for the garbage collection.
+  ///
+  /// @tparam F  The function type accepting BDD functions.
+  ///
+  /// @param[in] visit  The function to call for every root.
+  template <class F>
+  void VisitRoots(F&& visit) noexcept;
+
+  /// Recycles the vertices unreachable from the roots.
+  ///
+  /// @pre All the live functions are held by the BDD (safe point).
+  ///
+  /// @post Computation tables are cleared.
+  void CollectGarbage() noexcept;
+
+  /// Gathers the live vertices of the unique table by variables
+  /// and counts the references to the vertices.
+  ///
+  /// @returns The levels of the variables in the ascending order.
+  ///
+  /// @pre There are no unreachable vertices in the arena.
+  std::vector<Level> GatherLevels() noexcept;
+
+  /// Swaps adjacent variables in place.
+  ///
+  /// @param[in,out] levels  The levels of the variables in the BDD.
+  /// @param[in] position  The position of the upper level to swap.
+  ///
+  /// @returns The change in the number of vertices.
+  int SwapLevels(std::vector<Level>* levels, int position) noexcept;
+
+  /// Finds or adds a reduced function graph of a level variable.
+  ///
+  /// @param[in,out] level  The level of the top variable.
+  /// @param[in] high  The high function.
+  /// @param[in] low  The low function.
+  ///
+  /// @returns The reduced function graph with a regular high edge.
+  ///
+  /// @post New vertices are registered in the level.
+  Function FindOrAddFunction(Level* level, const Function& high,
+                             const Function& low) noexcept;
+
+  /// Frees an unreferenced vertex upon reordering
+  /// and releases its references to the branches.
+  ///
+  /// @param[in] vertex  The vertex with no references.
+  void FreeVertex(Handle vertex) noexcept;
 
   /// Counts the number of if-then-else nodes.
   ///
@@ -928,7 +1837,7 @@ class Bdd : private boost::noncopyable {
   /// @returns The number of ITE nodes in the BDD.
   ///
   /// @pre Non-terminal node marks are clear (false).
-  int CountIteNodes(const VertexPtr& vertex) noexcept;
+  int CountIteNodes(Handle vertex) noexcept;
 
   /// Clears marks of vertices in BDD graph.
   ///
@@ -936,7 +1845,7 @@ class Bdd : private boost::noncopyable {
   /// @param[in] mark  The desired mark for the vertices.
   ///
   /// @note Marks will propagate to modules as well.
-  void ClearMarks(const VertexPtr& vertex, bool mark) noexcept;
+  void ClearMarks(Handle vertex, bool mark) noexcept;
 
   /// Checks BDD graphs for errors in the structure.
   /// Errors are assertions that fail at runtime.
@@ -944,49 +1853,78 @@ class Bdd : private boost::noncopyable {
   /// @param[in] vertex  The root vertex of BDD.
   ///
   /// @pre Non-terminal node marks are clear (false).
-  void TestStructure(const VertexPtr& vertex) noexcept;
+  void TestStructure(Handle vertex) noexcept;
 
   /// Clears all memoization tables.
   void ClearTables() noexcept {
     and_table_.clear();
     or_table_.clear();
+    xor_table_.clear();
   }
 
+  /// Clears the computation tables shared among threads
+  /// and grows them with the BDD.
+  void ClearSharedTables() noexcept;
+
   /// Freezes the graph.
-  /// Releases all possible memory from memoization and unique tables.
+  /// Releases all possible memory from memoization and unique tables
+  /// after the last garbage collection.
   ///
   /// @pre No more graph modifications after the freeze.
   void Freeze() noexcept {
-    unique_table_.Release();
-    ClearTables();
+    CollectGarbage();
+    arena_.Release();
     and_table_.reserve(0);
     or_table_.reserve(0);
+    xor_table_.reserve(0);
   }
 
   const Settings kSettings_;  ///< Analysis settings.
   Function root_;  ///< The root function of this BDD.
   bool coherent_;  ///< Inherited coherence from PDAG.
 
-  /// Table of unique if-then-else nodes denoting function graphs.
+  /// The arena of if-then-else nodes denoting function graphs
+  /// with the unique table of the nodes.
   /// The key consists of ite(index, id_high, id_low),
   /// where IDs are unique (id_high != id_low) identifications of
   /// unique reduced-ordered function graphs.
-  UniqueTable<Ite> unique_table_;
+  IteArena arena_;
 
   /// Tables of processed computations over functions.
   /// The argument functions are recorded with their IDs (not vertex indices).
   /// In order to keep only unique computations,
   /// the argument IDs must be ordered.
   /// The key is {min_id, max_id}.
+  /// The XOR table keeps only positive IDs
+  /// because complements are factored out of XOR.
   /// @{
   ComputeTable and_table_;
   ComputeTable or_table_;
+  ComputeTable xor_table_;
+  /// @}
+
+  /// The computation tables of the parallel Apply
+  /// with the same keys as the tables above.
+  /// The results are kept between the safe points.
+  /// @{
+  SharedCacheTable shared_and_table_;
+  SharedCacheTable shared_or_table_;
+  SharedCacheTable shared_xor_table_;
   /// @}
+  std::unique_ptr<TaskPool> pool_;  ///< The threads of the parallel Apply.
 
   std::unordered_map<int, Function> modules_;  ///< Module graphs.
   std::unordered_map<int, int> index_to_order_;  ///< Indices and orders.
-  const TerminalPtr kOne_;  ///< Terminal True.
-  int function_id_;  ///< Identification assignment for new function graphs.
+  /// The converted gates of the PDAG with the number of processed parents.
+  std::unordered_map<int, std::pair<Function, int>> gates_;
+  /// The arguments and partial results of the gates in conversion.
+  std::vector<Function> stack_;
+  /// The reference counts of the vertices during the reordering only.
+  std::vector<int> refs_;
+  /// The size of the arena to trigger the garbage collection.
+  int gc_threshold_;
+  /// The size of the unique table to trigger the variable reordering.
+  int reorder_threshold_;
   std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
 };
 
@@ -76,6 +76,10 @@ Config::Config(const std::string& config_file) {
     err << boost::errinfo_file_name(config_file);
     throw;
   }
+
+  if (boost::optional<xml::Element> cache = root.child("cache-dir")) {
+    settings_.cache_directory(normalize(cache->text().to_string(), base_path));
+  }
 }
 
 void Config::GatherInputFiles(const xml::Element& root,
@@ -108,6 +112,9 @@ void Config::GatherOptions(const xml::Element& root) {
       } else if (name == "approximation") {
         settings_.approximation(option_group.attribute("name"));
 
+      } else if (name == "monte-carlo") {
+        settings_.monte_carlo(*option_group.attribute<int>("trials"));
+
       } else if (name == "limits") {
         SetLimits(option_group);
       }
@@ -152,12 +159,18 @@ void Config::SetLimits(const xml::Element& limits) {
     } else if (name == "cut-off") {
       settings_.cut_off(limit.text<double>());
 
+    } else if (name == "top-products") {
+      settings_.top_products(limit.text<int>());
+
     } else if (name == "mission-time") {
       settings_.mission_time(limit.text<double>());
 
     } else if (name == "time-step") {
       settings_.time_step(limit.text<double>());
 
+    } else if (name == "time-tolerance") {
+      settings_.time_tolerance(limit.text<double>());
+
     } else if (name == "number-of-trials") {
       settings_.num_trials(limit.text<int>());
 
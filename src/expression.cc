@@ -25,12 +25,32 @@
 namespace scram {
 namespace mef {
 
+thread_local Expression::ThreadSampling* Expression::thread_sampling_ =
+    nullptr;
+
+Expression::ThreadSampling::ThreadSampling() noexcept
+    : previous_(thread_sampling_) {
+  thread_sampling_ = this;
+}
+
+Expression::ThreadSampling::~ThreadSampling() noexcept {
+  thread_sampling_ = previous_;
+}
+
 Expression::Expression(std::vector<Expression*> args)
     : args_(std::move(args)),
       sampled_value_(0),
       sampled_(false) {}
 
 double Expression::Sample() noexcept {
+  if (thread_sampling_) {
+    auto it = thread_sampling_->sampled_values_.find(this);
+    if (it != thread_sampling_->sampled_values_.end())
+      return it->second;
+    double value = this->DoSample();  // May invalidate the iterator.
+    thread_sampling_->sampled_values_.emplace(this, value);
+    return value;
+  }
   if (!sampled_) {
     sampled_ = true;
     sampled_value_ = this->DoSample();
@@ -38,10 +58,24 @@ double Expression::Sample() noexcept {
   return sampled_value_;
 }
 
+void Expression::sampled_value(double value) noexcept {
+  if (thread_sampling_) {
+    thread_sampling_->sampled_values_[this] = value;
+  } else {
+    sampled_ = true;
+    sampled_value_ = value;
+  }
+}
+
 void Expression::Reset() noexcept {
-  if (!sampled_)
-    return;
-  sampled_ = false;
+  if (thread_sampling_) {
+    if (!thread_sampling_->sampled_values_.erase(this))
+      return;
+  } else {
+    if (!sampled_)
+      return;
+    sampled_ = false;
+  }
   for (Expression* arg : args_)
     arg->Reset();
 }
@@ -50,5 +84,16 @@ bool Expression::IsDeviate() noexcept {
   return ext::any_of(args_, [](Expression* arg) { return arg->IsDeviate(); });
 }
 
+bool Expression::IsTimeDependent() noexcept {
+  return ext::any_of(args_,
+                     [](Expression* arg) { return arg->IsTimeDependent(); });
+}
+
+void Expression::GatherDiscontinuities(double max_time,
+                                       std::vector<double>* times) noexcept {
+  for (Expression* arg : args_)
+    arg->GatherDiscontinuities(max_time, times);
+}
+
 }  // namespace mef
 }  // namespace scram
@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -72,6 +73,26 @@ inline bool IsPositive(const Interval& interval) {
 /// after validation phases.
 class Expression : private boost::noncopyable {
  public:
+  /// Sampling state of expressions private to the current thread.
+  /// While an object of this class is alive,
+  /// the sampled values of expressions in the thread
+  /// are kept in the object instead of the shared expressions,
+  /// so that concurrent threads can sample the same expressions.
+  class ThreadSampling : private boost::noncopyable {
+   public:
+    /// Activates the private sampling state for the current thread.
+    ThreadSampling() noexcept;
+
+    /// Restores the previous sampling state of the thread.
+    ~ThreadSampling() noexcept;
+
+   private:
+    friend class Expression;
+    /// Sampled values of expressions in the current thread.
+    std::unordered_map<const Expression*, double> sampled_values_;
+    ThreadSampling* previous_;  ///< The enclosing sampling state if any.
+  };
+
   /// Constructor for use by derived classes
   /// to register their arguments.
   ///
@@ -112,7 +133,31 @@ class Expression : private boost::noncopyable {
   ///          may yield silent failure.
   virtual bool IsDeviate() noexcept;
 
+  /// Determines if the value of the expression depends on the mission time.
+  /// The default logic is to check arguments for the time dependence.
+  ///
+  /// @returns true if the expression's value changes with the mission time.
+  /// @returns false if the expression's value is the same at any time.
+  ///
+  /// @warning Improper registration of arguments
+  ///          may yield silent failure.
+  virtual bool IsTimeDependent() noexcept;
+
+  /// Gathers the mission time points
+  /// where the value of the expression changes abruptly,
+  /// e.g., periodic tests.
+  /// The value at the point is the limit from the left.
+  /// The default logic is to gather the points of the arguments.
+  ///
+  /// @param[in] max_time  The upper bound for the time points.
+  /// @param[in,out] times  The unordered time points (may have duplicates).
+  virtual void GatherDiscontinuities(double max_time,
+                                     std::vector<double>* times) noexcept;
+
   /// @returns A sampled value of this expression.
+  ///
+  /// @note The sampled value is private to the current thread
+  ///       if the thread has an active ThreadSampling state.
   double Sample() noexcept;
 
   /// This routine resets the sampling to get new values.
@@ -128,15 +173,26 @@ class Expression : private boost::noncopyable {
   void AddArg(Expression* arg) { args_.push_back(arg); }
 
  private:
+  friend class ExpressionTape;  // Samples in batches of trials.
+
   /// Runs sampling of the expression.
   /// Derived concrete classes must provide the calculation.
   ///
   /// @returns A sampled value of this expression.
   virtual double DoSample() noexcept = 0;
 
+  /// Stores the sampled value of this expression
+  /// as if it were sampled with the current random numbers.
+  ///
+  /// @param[in] value  The externally sampled value.
+  void sampled_value(double value) noexcept;
+
   std::vector<Expression*> args_;  ///< Expression's arguments.
   double sampled_value_;  ///< The sampled value.
   bool sampled_;  ///< Indication if the expression is already sampled.
+
+  /// The sampling state private to the current thread if any.
+  static thread_local ThreadSampling* thread_sampling_;
 };
 
 /// CRTP for Expressions with the same formula to evaluate and sample.
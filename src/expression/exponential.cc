@@ -182,6 +182,14 @@ double PeriodicTest::InstantRepair::Sample() noexcept {
                  time_.Sample());
 }
 
+void PeriodicTest::InstantRepair::GatherDiscontinuities(
+    double max_time, std::vector<double>* times) noexcept {
+  double tau = tau_.value();
+  double theta = theta_.value();
+  for (int i = 0; theta + i * tau < max_time; ++i)
+    times->push_back(theta + i * tau);
+}
+
 double PeriodicTest::InstantTest::Compute(double lambda, double mu, double tau,
                                           double theta, double time) noexcept {
   if (time <= theta)  // No test has been performed.
@@ -300,6 +308,18 @@ double PeriodicTest::Complete::value() noexcept {
                  sigma_.value(), omega_.value(), time_.value());
 }
 
+void PeriodicTest::Complete::GatherDiscontinuities(
+    double max_time, std::vector<double>* times) noexcept {
+  double tau = tau_.value();
+  double theta = theta_.value();
+  double test_duration = test_duration_.value();
+  for (int i = 0; theta + i * tau < max_time; ++i) {
+    times->push_back(theta + i * tau);  // The test start.
+    if (test_duration)
+      times->push_back(theta + i * tau + test_duration);  // The test end.
+  }
+}
+
 double PeriodicTest::Complete::Sample() noexcept {
   return Compute(lambda_.Sample(), lambda_test_.Sample(), mu_.Sample(),
                  tau_.Sample(), theta_.Sample(), gamma_.Sample(),
@@ -23,6 +23,7 @@
 #define SCRAM_SRC_EXPRESSION_EXPONENTIAL_H_
 
 #include <memory>
+#include <vector>
 
 #include "src/expression.h"
 
@@ -161,6 +162,12 @@ class PeriodicTest : public Expression {
   double value() noexcept override { return flavor_->value(); }
   Interval interval() noexcept override { return Interval::closed(0, 1); }
 
+  /// Gathers the test times, where the probability drops or jumps.
+  void GatherDiscontinuities(double max_time,
+                             std::vector<double>* times) noexcept override {
+    flavor_->GatherDiscontinuities(max_time, times);
+  }
+
  private:
   double DoSample() noexcept override { return flavor_->Sample(); }
 
@@ -173,6 +180,9 @@ class PeriodicTest : public Expression {
     virtual double value() noexcept = 0;
     /// @copydoc Expression::Sample
     virtual double Sample() noexcept = 0;
+    /// @copydoc Expression::GatherDiscontinuities
+    virtual void GatherDiscontinuities(double max_time,
+                                       std::vector<double>* times) noexcept = 0;
   };
 
   /// The tests and repairs are instantaneous and always successful.
@@ -186,6 +196,8 @@ class PeriodicTest : public Expression {
     void Validate() const override;
     double value() noexcept override;
     double Sample() noexcept override;
+    void GatherDiscontinuities(double max_time,
+                               std::vector<double>* times) noexcept override;
 
    protected:
     Expression& lambda_;  ///< The failure rate when functioning.
@@ -243,6 +255,8 @@ class PeriodicTest : public Expression {
     void Validate() const override;
     double value() noexcept override;
     double Sample() noexcept override;
+    void GatherDiscontinuities(double max_time,
+                               std::vector<double>* times) noexcept override;
 
    private:
     /// Computes the expression value.
@@ -53,6 +53,11 @@ double UniformDeviate::DoSample() noexcept {
   return Random::UniformRealGenerator(min_.value(), max_.value());
 }
 
+void UniformDeviate::DoSample(int num_samples, double* samples) noexcept {
+  Random::UniformRealGenerator(min_.value(), max_.value(), num_samples,
+                               samples);
+}
+
 NormalDeviate::NormalDeviate(Expression* mean, Expression* sigma)
     : RandomDeviate({mean, sigma}),
       mean_(*mean),
@@ -68,6 +73,10 @@ double NormalDeviate::DoSample() noexcept {
   return Random::NormalGenerator(mean_.value(), sigma_.value());
 }
 
+void NormalDeviate::DoSample(int num_samples, double* samples) noexcept {
+  Random::NormalGenerator(mean_.value(), sigma_.value(), num_samples, samples);
+}
+
 LognormalDeviate::LognormalDeviate(Expression* mean, Expression* ef,
                                    Expression* level)
     : RandomDeviate({mean, ef, level}),
@@ -93,6 +102,11 @@ double LognormalDeviate::DoSample() noexcept {
   return Random::LognormalGenerator(flavor_->location(), flavor_->scale());
 }
 
+void LognormalDeviate::DoSample(int num_samples, double* samples) noexcept {
+  Random::LognormalGenerator(flavor_->location(), flavor_->scale(),
+                             num_samples, samples);
+}
+
 Interval LognormalDeviate::interval() noexcept {
   double high_estimate = std::exp(3 * flavor_->scale() + flavor_->location());
   return Interval::left_open(0, high_estimate);
@@ -143,6 +157,10 @@ double GammaDeviate::DoSample() noexcept {
   return Random::GammaGenerator(k_.value(), theta_.value());
 }
 
+void GammaDeviate::DoSample(int num_samples, double* samples) noexcept {
+  Random::GammaGenerator(k_.value(), theta_.value(), num_samples, samples);
+}
+
 BetaDeviate::BetaDeviate(Expression* alpha, Expression* beta)
     : RandomDeviate({alpha, beta}),
       alpha_(*alpha),
@@ -168,6 +186,10 @@ double BetaDeviate::DoSample() noexcept {
   return Random::BetaGenerator(alpha_.value(), beta_.value());
 }
 
+void BetaDeviate::DoSample(int num_samples, double* samples) noexcept {
+  Random::BetaGenerator(alpha_.value(), beta_.value(), num_samples, samples);
+}
+
 Histogram::Histogram(std::vector<Expression*> boundaries,
                      std::vector<Expression*> weights)
     : RandomDeviate(std::move(boundaries)) {  // Partial registration!
@@ -229,5 +251,12 @@ double Histogram::DoSample() noexcept {
                                     make_sampler(weights_.begin()));
 }
 
+void Histogram::DoSample(int num_samples, double* samples) noexcept {
+  Random::HistogramGenerator(make_sampler(boundaries_.begin()),
+                             make_sampler(boundaries_.end()),
+                             make_sampler(weights_.begin()), num_samples,
+                             samples);
+}
+
 }  // namespace mef
 }  // namespace scram
@@ -37,8 +37,26 @@ namespace mef {
 class RandomDeviate : public Expression {
  public:
   using Expression::Expression;
+  using Expression::Sample;
 
   bool IsDeviate() noexcept override { return true; }
+
+  /// Samples the distribution for a batch of independent trials.
+  /// Unlike the single sample,
+  /// the batch samples are not stored in the expression.
+  ///
+  /// @param[in] num_samples  The number of samples to generate.
+  /// @param[out] samples  The destination array for the samples.
+  void Sample(int num_samples, double* samples) noexcept {
+    this->DoSample(num_samples, samples);
+  }
+
+ private:
+  /// Runs the batch sampling of the distribution.
+  ///
+  /// @param[in] num_samples  The number of samples to generate.
+  /// @param[out] samples  The destination array for the samples.
+  virtual void DoSample(int num_samples, double* samples) noexcept = 0;
 };
 
 /// Uniform distribution.
@@ -60,6 +78,7 @@ class UniformDeviate : public RandomDeviate {
 
  private:
   double DoSample() noexcept override;
+  void DoSample(int num_samples, double* samples) noexcept override;
 
   Expression& min_;  ///< Minimum value of the distribution.
   Expression& max_;  ///< Maximum value of the distribution.
@@ -87,6 +106,7 @@ class NormalDeviate : public RandomDeviate {
 
  private:
   double DoSample() noexcept override;
+  void DoSample(int num_samples, double* samples) noexcept override;
 
   Expression& mean_;  ///< Mean value of normal distribution.
   Expression& sigma_;  ///< Standard deviation of normal distribution.
@@ -122,6 +142,7 @@ class LognormalDeviate : public RandomDeviate {
 
  private:
   double DoSample() noexcept override;
+  void DoSample(int num_samples, double* samples) noexcept override;
 
   /// Support for parametrization differences.
   struct Flavor {
@@ -192,6 +213,7 @@ class GammaDeviate : public RandomDeviate {
 
  private:
   double DoSample() noexcept override;
+  void DoSample(int num_samples, double* samples) noexcept override;
 
   Expression& k_;  ///< The shape parameter of the gamma distribution.
   Expression& theta_;  ///< The scale factor of the gamma distribution.
@@ -219,6 +241,7 @@ class BetaDeviate : public RandomDeviate {
 
  private:
   double DoSample() noexcept override;
+  void DoSample(int num_samples, double* samples) noexcept override;
 
   Expression& alpha_;  ///< The alpha shape parameter.
   Expression& beta_;  ///< The beta shape parameter.
@@ -256,6 +279,7 @@ class Histogram : public RandomDeviate {
       boost::iterator_range<std::vector<Expression*>::const_iterator>;
 
   double DoSample() noexcept override;
+  void DoSample(int num_samples, double* samples) noexcept override;
 
   IteratorRange boundaries_;  ///< Boundaries of the intervals.
   IteratorRange weights_;  ///< Weights of the intervals.
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2014-2017 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file expression_tape.cc
+/// Implementation of the expression compilation and evaluation.
+
+#include "expression_tape.h"
+
+#include <cassert>
+
+#include <algorithm>
+#include <functional>
+
+#include <boost/range/algorithm/find.hpp>
+
+#include "expression/exponential.h"
+#include "expression/numerical.h"
+#include "expression/random_deviate.h"
+#include "parameter.h"
+
+namespace scram {
+namespace mef {
+
+ExpressionTape::ExpressionTape(const std::vector<Expression*>& expressions,
+                               bool sample) noexcept
+    : sample_(sample) {
+  std::unordered_map<Expression*, int> slots;
+  std::vector<int> outputs;  // Slots before the constant shift.
+  for (Expression* expression : expressions)
+    outputs.push_back(Compile(expression, &slots));
+  // The constants are placed before the instructions.
+  auto shift = [this](int slot) {
+    return slot < 0 ? -slot - 1 : slot + constants_.size();
+  };
+  for (int& arg : args_)
+    arg = shift(arg);
+  for (int slot : outputs)
+    outputs_.push_back(shift(slot));
+}
+
+namespace {
+
+/// Gathers the random deviates that the sample of an expression depends on.
+///
+/// @param[in] expression  The expression with deviate arguments.
+/// @param[in,out] deviates  The unique random deviates.
+void GatherDeviates(Expression* expression,
+                    std::vector<RandomDeviate*>* deviates) noexcept {
+  for (Expression* arg : expression->args()) {
+    if (!arg->IsDeviate())
+      continue;
+    if (auto* deviate = dynamic_cast<RandomDeviate*>(arg)) {
+      if (boost::find(*deviates, deviate) == deviates->end())
+        deviates->push_back(deviate);
+    } else {
+      GatherDeviates(arg, deviates);
+    }
+  }
+}
+
+}  // namespace
+
+int ExpressionTape::Compile(
+    Expression* expression,
+    std::unordered_map<Expression*, int>* slots) noexcept {
+  auto it = slots->find(expression);
+  if (it != slots->end())
+    return it->second;
+
+  // The slots of constants are encoded as negative numbers
+  // until the number of constants is known.
+  int slot = 0;
+  if (!(sample_ ? expression->IsDeviate() : expression->IsTimeDependent())) {
+    constants_.push_back(expression->value());
+    slot = -static_cast<int>(constants_.size());
+  } else if (auto* parameter = dynamic_cast<Parameter*>(expression)) {
+    slot = Compile(parameter->args().front(), slots);
+  } else {
+    Operation operation = GetOperation(expression);
+    std::vector<int> args;
+    if (operation == kSample) {  // The deviates to seed the sampling.
+      std::vector<RandomDeviate*> deviates;
+      GatherDeviates(expression, &deviates);
+      for (RandomDeviate* deviate : deviates)
+        args.push_back(Compile(deviate, slots));
+    } else if (operation != kValue && operation != kDeviate) {
+      for (Expression* arg : expression->args())
+        args.push_back(Compile(arg, slots));
+    }
+    slot = instructions_.size();
+    instructions_.push_back({operation, static_cast<int>(args_.size()),
+                             static_cast<int>(args.size()), expression});
+    args_.insert(args_.end(), args.begin(), args.end());
+  }
+  slots->emplace(expression, slot);
+  return slot;
+}
+
+ExpressionTape::Operation
+ExpressionTape::GetOperation(Expression* expression) const noexcept {
+  if (dynamic_cast<Neg*>(expression))
+    return kNeg;
+  if (dynamic_cast<Add*>(expression))
+    return kAdd;
+  if (dynamic_cast<Sub*>(expression))
+    return kSub;
+  if (dynamic_cast<Mul*>(expression))
+    return kMul;
+  if (dynamic_cast<Div*>(expression))
+    return kDiv;
+  if (dynamic_cast<Exponential*>(expression))
+    return kExponential;
+  if (dynamic_cast<Glm*>(expression))
+    return kGlm;
+  if (dynamic_cast<Weibull*>(expression))
+    return kWeibull;
+  if (!sample_)
+    return kValue;
+  return dynamic_cast<RandomDeviate*>(expression) ? kDeviate : kSample;
+}
+
+void ExpressionTape::Evaluate(double* values, int num_trials) const
+    noexcept {
+  assert(num_trials > 0);
+  assert((sample_ || num_trials == 1) && "Mean values are the same.");
+  std::vector<double> slots((constants_.size() + instructions_.size()) *
+                            num_trials);
+  double* result = slots.data();
+  for (double constant : constants_) {
+    std::fill_n(result, num_trials, constant);
+    result += num_trials;
+  }
+  for (const Instruction& instruction : instructions_) {
+    Apply(instruction, slots.data(), num_trials, result);
+    result += num_trials;
+  }
+
+  for (int slot : outputs_) {
+    std::copy_n(slots.data() + slot * num_trials, num_trials, values);
+    values += num_trials;
+  }
+}
+
+void ExpressionTape::Apply(const Instruction& instruction, const double* slots,
+                           int num_trials, double* result) const noexcept {
+  const int* args = args_.data() + instruction.first_arg;
+  // The values of the argument for all the trials.
+  auto arg = [args, slots, num_trials](int i) {
+    return slots + args[i] * num_trials;
+  };
+  // Left fold of the arguments as in the n-ary expressions.
+  auto fold = [&](auto op) {
+    std::copy_n(arg(0), num_trials, result);
+    for (int i = 1; i < instruction.num_args; ++i) {
+      const double* values = arg(i);
+      for (int j = 0; j < num_trials; ++j)
+        result[j] = op(result[j], values[j]);
+    }
+  };
+  // Computes the values of the formula with four arguments per trial.
+  auto compute = [&](auto* formula) {
+    const double* a = arg(0);
+    const double* b = arg(1);
+    const double* c = arg(2);
+    const double* d = arg(3);
+    for (int j = 0; j < num_trials; ++j)
+      result[j] = formula->Compute(a[j], b[j], c[j], d[j]);
+  };
+  switch (instruction.operation) {
+    case kValue:
+      std::fill_n(result, num_trials, instruction.expression->value());
+      break;
+    case kSample:
+      for (int j = 0; j < num_trials; ++j) {
+        instruction.expression->Reset();
+        for (int i = 0; i < instruction.num_args; ++i) {
+          Expression* deviate = instructions_[args[i] - constants_.size()]
+                                    .expression;
+          deviate->sampled_value(arg(i)[j]);
+        }
+        result[j] = instruction.expression->Sample();
+      }
+      break;
+    case kDeviate:
+      static_cast<RandomDeviate*>(instruction.expression)
+          ->Sample(num_trials, result);
+      break;
+    case kNeg: {
+      const double* values = arg(0);
+      for (int j = 0; j < num_trials; ++j)
+        result[j] = -values[j];
+      break;
+    }
+    case kAdd:
+      fold(std::plus<>());
+      break;
+    case kSub:
+      fold(std::minus<>());
+      break;
+    case kMul:
+      fold(std::multiplies<>());
+      break;
+    case kDiv:
+      fold(std::divides<>());
+      break;
+    case kExponential: {
+      auto* exponential = static_cast<Exponential*>(instruction.expression);
+      const double* lambda = arg(0);
+      const double* time = arg(1);
+      for (int j = 0; j < num_trials; ++j)
+        result[j] = exponential->Compute(lambda[j], time[j]);
+      break;
+    }
+    case kGlm:
+      compute(static_cast<Glm*>(instruction.expression));
+      break;
+    case kWeibull:
+      compute(static_cast<Weibull*>(instruction.expression));
+      break;
+  }
+}
+
+}  // namespace mef
+}  // namespace scram
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2014-2017 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file expression_tape.h
+/// Compilation of expressions into a flat evaluation tape.
+
+#ifndef SCRAM_SRC_EXPRESSION_TAPE_H_
+#define SCRAM_SRC_EXPRESSION_TAPE_H_
+
+#include <cstdint>
+
+#include <unordered_map>
+#include <vector>
+
+#include "expression.h"
+
+namespace scram {
+namespace mef {
+
+/// Expressions compiled into a flat tape of instructions
+/// over the slots of values shared by all the compiled expressions.
+///
+/// The subexpressions that do not vary,
+/// i.e., do not depend on the mission time for mean values
+/// or are not deviates for samples,
+/// are folded into constant slots upon compilation.
+/// Parameters are aliases of their expression slots.
+/// The arithmetic and exponential expressions
+/// become instructions evaluated in a single loop
+/// in the topological order (arguments first),
+/// so every shared subexpression is evaluated only once.
+/// The other varying expressions are leaves of the tape
+/// evaluated with their own virtual functions.
+///
+/// The sampling tape evaluates a batch of independent trials at once
+/// with the values of slots stored contiguously for all the trials.
+/// The random deviates fill the batch of samples together,
+/// and the sampled values propagate through the instructions in bulk.
+/// The other sampled leaves get the deviate samples of their trial
+/// as if the deviates were sampled on their own.
+///
+/// @note The tape refers to the expressions,
+///       which must outlive the tape and not change after the compilation.
+class ExpressionTape {
+ public:
+  /// Compiles the expressions.
+  ///
+  /// @param[in] expressions  The expressions to evaluate together.
+  /// @param[in] sample  The flag to sample the expressions
+  ///                    instead of calculating their mean values.
+  explicit ExpressionTape(const std::vector<Expression*>& expressions,
+                          bool sample = false) noexcept;
+
+  /// @returns The number of compiled expressions.
+  int size() const { return outputs_.size(); }
+
+  /// @returns The number of instructions left after the folding.
+  int num_instructions() const { return instructions_.size(); }
+
+  /// Evaluates the mean values or samples of all the compiled expressions.
+  ///
+  /// @param[out] values  The destination for the values of the expressions
+  ///                     in the order of compilation.
+  ///                     The values of each expression are contiguous
+  ///                     for all the trials.
+  /// @param[in] num_trials  The number of independent trials to sample.
+  ///
+  /// @pre The number of trials is 1 for mean values.
+  ///
+  /// @note This function is safe to call concurrently
+  ///       as long as the threads own their mission time, sampling state,
+  ///       and random number streams.
+  void Evaluate(double* values, int num_trials = 1) const noexcept;
+
+ private:
+  /// The operations of the instructions.
+  enum Operation : std::uint8_t {
+    kValue,  ///< The mean value of the expression itself.
+    kSample,  ///< The sampled value of the expression with deviate arguments.
+    kDeviate,  ///< The batch of samples of the random deviate.
+    kNeg,
+    kAdd,
+    kSub,
+    kMul,
+    kDiv,
+    kExponential,
+    kGlm,
+    kWeibull
+  };
+
+  /// The instruction producing the value of its slot.
+  struct Instruction {
+    Operation operation;  ///< The operation on the arguments.
+    int first_arg;  ///< The position of the first argument slot.
+    int num_args;  ///< The number of arguments.
+    Expression* expression;  ///< The source expression.
+  };
+
+  /// Compiles an expression and its arguments.
+  ///
+  /// @param[in] expression  The expression to compile.
+  /// @param[in,out] slots  The slots of compiled expressions.
+  ///
+  /// @returns The slot of the expression value.
+  int Compile(Expression* expression,
+              std::unordered_map<Expression*, int>* slots) noexcept;
+
+  /// @returns The operation to compile the expression with.
+  Operation GetOperation(Expression* expression) const noexcept;
+
+  /// Applies the instruction to the values of slots.
+  ///
+  /// @param[in] instruction  The instruction to apply.
+  /// @param[in] slots  The values of the tape slots.
+  /// @param[in] num_trials  The number of trials in the slots.
+  /// @param[out] result  The values of the instruction for the trials.
+  void Apply(const Instruction& instruction, const double* slots,
+             int num_trials, double* result) const noexcept;
+
+  bool sample_;  ///< The indication of the sampling tape.
+  std::vector<double> constants_;  ///< The values of the first slots.
+  std::vector<Instruction> instructions_;  ///< The slots after the constants.
+  std::vector<int> args_;  ///< The argument slots of instructions.
+  std::vector<int> outputs_;  ///< The slots of the compiled expressions.
+};
+
+}  // namespace mef
+}  // namespace scram
+
+#endif  // SCRAM_SRC_EXPRESSION_TAPE_H_
@@ -20,7 +20,10 @@
 
 #include "fault_tree_analysis.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include <boost/container/flat_set.hpp>
@@ -32,6 +35,14 @@
 namespace scram {
 namespace core {
 
+namespace {
+
+/// The number of products enumerated
+/// to estimate the time of the avoided enumeration.
+const int kMinEnumerationSample = 1000;
+
+}  // namespace
+
 void Print(const ProductContainer& products) {
   if (products.empty()) {
     std::cerr << "No products!" << std::endl;
@@ -43,7 +54,7 @@ void Print(const ProductContainer& products) {
     return;
   }
   std::cerr << " " << products.size() << " : {";
-  for (int i : products.Distribution())
+  for (std::int64_t i : products.Distribution())
     std::cerr << " " << i;
   std::cerr << " }\n\n";
 
@@ -79,15 +90,32 @@ double Product::p() const {
   return p;
 }
 
-std::vector<int> ProductContainer::Distribution() const {
-  std::vector<int> distribution;
-  for (const std::vector<int>& product : products_) {
-    int index = product.empty() ? 0 : product.size() - 1;
-    if (distribution.size() <= index)
-      distribution.resize(index + 1);
-    distribution[index]++;
+ProductContainer::ProductContainer(const Zbdd& products,
+                                   const Zbdd& all_products,
+                                   const Pdag& graph) noexcept
+    : products_(products),
+      all_products_(all_products),
+      graph_(graph),
+      size_(0) {
+  for (int index : products_.GatherVariables())
+    product_events_.insert(graph_.basic_events()[index]);
+  std::vector<std::int64_t> counts = products_.Distribution();
+  for (int k = 0; k < counts.size(); ++k) {
+    size_ += counts[k];
+    int index = k ? k - 1 : 0;  // The Base set is reported with order 1.
+    if (distribution_.size() <= index)
+      distribution_.resize(index + 1);
+    distribution_[index] += counts[k];
   }
-  return distribution;
+  total_size_ = &all_products_ == &products_ ? size_ : all_products_.size();
+}
+
+double ProductContainer::p_sum() const {
+  Pdag::IndexMap<double> p_vars;
+  p_vars.reserve(graph_.basic_events().size());
+  for (const mef::BasicEvent* event : graph_.basic_events())
+    p_vars.push_back(event->p());
+  return all_products_.CalculateProbabilitySum(p_vars);
 }
 
 FaultTreeAnalysis::FaultTreeAnalysis(const mef::Gate& root,
@@ -109,6 +137,10 @@ void FaultTreeAnalysis::Analyze() noexcept {
   const Zbdd& products = this->GenerateProducts(graph_.get());
   LOG(DEBUG2) << "The algorithm finished in " << DUR(algo_time);
   LOG(DEBUG2) << "# of products: " << products.size();
+  if (Analysis::settings().top_products() &&
+      Analysis::settings().probability_analysis()) {
+    ExtractTopProducts(products, *graph_);
+  }
 
   Analysis::AddAnalysisTime(DUR(analysis_time));
   CLOCK(store_time);
@@ -116,15 +148,67 @@ void FaultTreeAnalysis::Analyze() noexcept {
   LOG(DEBUG2) << "Stored the result for reporting in " << DUR(store_time);
 }
 
+void FaultTreeAnalysis::ExtractTopProducts(const Zbdd& products,
+                                           const Pdag& graph) noexcept {
+  CLOCK(top_time);
+  std::vector<std::int64_t> counts = products.Distribution();
+  std::int64_t num_products = 0;
+  std::int64_t num_literals = 0;
+  for (int k = 0; k < counts.size(); ++k) {
+    num_products += counts[k];
+    num_literals += k * counts[k];
+  }
+  int num_top = Analysis::settings().top_products();
+  if (num_products <= num_top)
+    return;
+  Pdag::IndexMap<double> p_vars;
+  p_vars.reserve(graph.basic_events().size());
+  for (const mef::BasicEvent* event : graph.basic_events())
+    p_vars.push_back(event->p());
+  top_products_ = products.TopProducts(num_top, p_vars);
+  LOG(DEBUG2) << "Extracted " << num_top << " most probable products in "
+              << DUR(top_time);
+
+  // The time of the avoided enumeration is extrapolated
+  // from the enumeration of the first products.
+  std::int64_t num_sample = std::min<std::int64_t>(
+      num_products, std::max(num_top, kMinEnumerationSample));
+  CLOCK(enumeration_time);
+  std::vector<std::vector<int>> sample;
+  for (auto it = products.begin(); sample.size() < num_sample; ++it)
+    sample.push_back(*it);
+  double seconds = DUR(enumeration_time) * num_products / sample.size();
+  // The memory to hold the avoided products in vectors of indices.
+  double megabytes = (num_literals * sizeof(int) +
+                      num_products * sizeof(std::vector<int>)) /
+                     static_cast<double>(1 << 20);
+  std::ostringstream msg;
+  msg << "Only the " << num_top
+      << " most probable products are reported out of " << num_products
+      << "; the enumeration of " << num_literals << " literals (~"
+      << std::setprecision(3) << megabytes << " MiB, ~" << seconds
+      << " s) is avoided.";
+  Analysis::AddWarning(msg.str());
+}
+
 void FaultTreeAnalysis::Store(const Zbdd& products,
                               const Pdag& graph) noexcept {
+  products_ = std::make_unique<const ProductContainer>(
+      top_products_ ? *top_products_ : products, products, graph);
   // Special cases of sets.
-  if (products.empty()) {
+  if (products_->empty()) {
     Analysis::AddWarning("The set is NULL/Empty.");
   } else if (products.base()) {
     Analysis::AddWarning("The set is UNITY/Base.");
   }
-  products_ = std::make_unique<const ProductContainer>(products, graph);
+  if (double mass = products.truncated_mass()) {
+    std::ostringstream msg;
+    msg << "Products below the probability cut-off "
+        << Analysis::settings().cut_off()
+        << " are truncated with the estimated probability mass of " << mass
+        << ".";
+    Analysis::AddWarning(msg.str());
+  }
 
 #ifndef NDEBUG
   for (const Product& product : *products_)
@@ -21,6 +21,7 @@
 #ifndef SCRAM_SRC_FAULT_TREE_ANALYSIS_H_
 #define SCRAM_SRC_FAULT_TREE_ANALYSIS_H_
 
+#include <cstdint>
 #include <cstdlib>
 
 #include <memory>
@@ -122,24 +123,19 @@ class ProductContainer {
   };
 
  public:
-  /// The constructor also collects basic events in products.
+  /// The constructor also collects basic events in products
+  /// and counts the products without enumeration.
   ///
   /// @param[in] products  Sets with indices of events from calculations.
   /// @param[in] graph  PDAG with basic event indices and pointers.
   ProductContainer(const Zbdd& products, const Pdag& graph) noexcept
-      : products_(products),
-        graph_(graph) {
-    Pdag::IndexMap<bool> filter(graph_.basic_events().size());
-    for (const std::vector<int>& result_set : products_) {
-      for (int i : result_set) {
-        i = std::abs(i);
-        if (filter[i])
-          continue;
-        filter[i] = true;
-        product_events_.insert(graph_.basic_events()[i]);
-      }
-    }
-  }
+      : ProductContainer(products, products, graph) {}
+
+  /// @param[in] products  The reported part of all the products.
+  /// @param[in] all_products  All the products from calculations.
+  /// @param[in] graph  PDAG with basic event indices and pointers.
+  ProductContainer(const Zbdd& products, const Zbdd& all_products,
+                   const Pdag& graph) noexcept;
 
   /// @returns Collection of basic events that are in the products.
   const std::unordered_set<const mef::BasicEvent*>& product_events() const {
@@ -159,19 +155,35 @@ class ProductContainer {
   /// @}
 
   /// @returns true if no products in the container.
-  bool empty() const { return products_.empty(); }
+  bool empty() const { return size_ == 0; }
 
   /// @returns The number of products in the container.
-  int size() const { return products_.size(); }
+  std::int64_t size() const { return size_; }
+
+  /// @returns The number of all the products
+  ///          including the products left out of the container.
+  std::int64_t total_size() const { return total_size_; }
 
   /// @returns The product distribution by order.
-  std::vector<int> Distribution() const;
+  const std::vector<std::int64_t>& Distribution() const {
+    return distribution_;
+  }
+
+  /// @returns The sum of the probabilities of all the products
+  ///          including the products left out of the container.
+  ///
+  /// @pre Events are initialized with expressions.
+  double p_sum() const;
 
  private:
   const Zbdd& products_;  ///< Container of analysis results.
+  const Zbdd& all_products_;  ///< All the products from the analysis.
   const Pdag& graph_;  ///< The analysis graph.
   /// The set of events in the resultant products.
   std::unordered_set<const mef::BasicEvent*> product_events_;
+  std::int64_t size_;  ///< The number of products.
+  std::int64_t total_size_;  ///< The number of all the products.
+  std::vector<std::int64_t> distribution_;  ///< The products by order.
 };
 
 /// Prints a collection of products to the standard error.
@@ -273,6 +285,15 @@ class FaultTreeAnalysis : public Analysis {
   /// @post The result ZBDD lives as long as the host analysis.
   virtual const Zbdd& GenerateProducts(const Pdag* graph) noexcept = 0;
 
+  /// Extracts the most probable products
+  /// if the full enumeration of products can be avoided.
+  ///
+  /// @param[in] products  Sets with indices of events from calculations.
+  /// @param[in] graph  PDAG with basic event indices and pointers.
+  ///
+  /// @pre The basic events have probability expressions.
+  void ExtractTopProducts(const Zbdd& products, const Pdag& graph) noexcept;
+
   /// Stores resultant sets of products for future reporting.
   ///
   /// @param[in] products  Sets with indices of events from calculations.
@@ -281,6 +302,8 @@ class FaultTreeAnalysis : public Analysis {
 
   const mef::Gate& top_event_;  ///< The root of the graph under analysis.
   std::unique_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
+  /// The most probable products extracted for reporting if requested.
+  std::unique_ptr<const Zbdd> top_products_;
   std::unique_ptr<const ProductContainer> products_;  ///< Container of results.
 };
 
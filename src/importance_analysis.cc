@@ -23,6 +23,8 @@
 
 #include <cstdlib>
 
+#include <algorithm>
+
 #include "event.h"
 #include "logger.h"
 #include "zbdd.h"
@@ -41,6 +43,7 @@ void ImportanceAnalysis::Analyze() noexcept {
       this->basic_events();
 
   std::vector<int> occurrences = this->occurrences();
+  std::vector<double> mifs = this->CalculateMif(occurrences);
   for (int i = 0; i < basic_events.size(); ++i) {
     if (occurrences[i] == 0)
       continue;
@@ -48,7 +51,7 @@ void ImportanceAnalysis::Analyze() noexcept {
     double p_var = event.p();
     ImportanceFactors imp{};
     imp.occurrence = occurrences[i];
-    imp.mif = this->CalculateMif(i);
+    imp.mif = mifs[i];
     if (p_total != 0) {
       imp.cif = p_var * imp.mif / p_total;
       imp.raw = 1 + (1 - p_var) * imp.mif / p_total;
@@ -71,78 +74,46 @@ std::vector<int> ImportanceAnalyzerBase::occurrences() noexcept {
   return result;
 }
 
-double ImportanceAnalyzer<Bdd>::CalculateMif(int index) noexcept {
-  index += Pdag::kVariableStartIndex;
-  const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
-  if (root->terminal())
-    return 0;
-  bool original_mark = Ite::Ref(root).mark();
-
-  int order = bdd_graph_->index_to_order().find(index)->second;
-  double mif = CalculateMif(root, order, !original_mark);
-  bdd_graph_->ClearMarks(original_mark);
-  return mif;
-}
-
-double ImportanceAnalyzer<Bdd>::CalculateMif(const Bdd::VertexPtr& vertex,
-                                             int order, bool mark) noexcept {
-  if (vertex->terminal())
-    return 0;
-  Ite& ite = Ite::Ref(vertex);
-  if (ite.mark() == mark)
-    return ite.factor();
-  ite.mark(mark);
-  if (ite.order() > order) {
-    if (!ite.module()) {
-      ite.factor(0);
-    } else {  /// @todo Detect if the variable is in the module.
-      // The assumption is
-      // that the order of a module is always larger
-      // than the order of its variables.
-      double high = RetrieveProbability(ite.high());
-      double low = RetrieveProbability(ite.low());
-      if (ite.complement_edge())
-        low = 1 - low;
-      const Bdd::Function& res =
-          bdd_graph_->modules().find(ite.index())->second;
-      double mif = CalculateMif(res.vertex, order, mark);
-      if (res.complement)
-        mif = -mif;
-      ite.factor((high - low) * mif);
-    }
-  } else if (ite.order() == order) {
-    assert(!ite.module() && "A variable can't be a module.");
-    double high = RetrieveProbability(ite.high());
-    double low = RetrieveProbability(ite.low());
-    if (ite.complement_edge())
-      low = 1 - low;
-    ite.factor(high - low);
-  } else  {
-    assert(ite.order() < order);
-    double p_var = 0;
-    if (ite.module()) {
-      const Bdd::Function& res =
-          bdd_graph_->modules().find(ite.index())->second;
-      p_var = RetrieveProbability(res.vertex);
-      if (res.complement)
-        p_var = 1 - p_var;
-    } else {
-      p_var = prob_analyzer()->p_vars()[ite.index()];
-    }
-    double high = CalculateMif(ite.high(), order, mark);
-    double low = CalculateMif(ite.low(), order, mark);
-    if (ite.complement_edge())
-      low = -low;
-    ite.factor(p_var * high + (1 - p_var) * low);
+std::vector<double> ImportanceAnalyzer<Bdd>::CalculateMif(
+    const std::vector<int>& occurrences) noexcept {
+  std::vector<double> mif(occurrences.size());
+  auto* bdd_analyzer = static_cast<ProbabilityAnalyzer<Bdd>*>(prob_analyzer());
+  const FlatBdd& bdd = bdd_analyzer->flat_bdd();
+  if (!bdd.size())
+    return mif;
+  const Pdag::IndexMap<double>& p_vars = bdd_analyzer->p_vars();
+  std::vector<double> p(bdd.first_vertex() + bdd.size());  // The forward sweep.
+  p[0] = 1;  // The terminal vertex.
+  std::copy(p_vars.begin(), p_vars.end(), p.begin() + 1);
+  auto variable_p = [&p, &bdd](int i) {
+    return bdd.var_complement[i] ? 1 - p[bdd.var[i]] : p[bdd.var[i]];
+  };
+  auto low_p = [&p, &bdd](int i) {
+    return bdd.complement_edge[i] ? 1 - p[bdd.low[i]] : p[bdd.low[i]];
+  };
+  for (int i = 0; i < bdd.size(); ++i) {
+    double p_var = variable_p(i);
+    p[bdd.first_vertex() + i] = p_var * p[bdd.high[i]] + (1 - p_var) * low_p(i);
   }
-  return ite.factor();
-}
 
-double ImportanceAnalyzer<Bdd>::RetrieveProbability(
-    const Bdd::VertexPtr& vertex) noexcept {
-  if (vertex->terminal())
-    return 1;
-  return Ite::Ref(vertex).p();
+  // The partial derivatives of the total probability
+  // w.r.t. the values of the slots
+  // are accumulated in the reverse topological order.
+  // The derivatives w.r.t. the variable slots are the MIF,
+  // and the terminal slot is ignored.
+  std::vector<double> d(p.size());
+  d[bdd.root] = bdd.root_complement ? -1 : 1;
+  for (int i = bdd.size() - 1; i >= 0; --i) {
+    double d_vertex = d[bdd.first_vertex() + i];
+    double d_var = d_vertex * (p[bdd.high[i]] - low_p(i));  // Shannon.
+    d[bdd.var[i]] += bdd.var_complement[i] ? -d_var : d_var;
+    double p_var = variable_p(i);
+    d[bdd.high[i]] += d_vertex * p_var;
+    double d_low = d_vertex * (1 - p_var);
+    d[bdd.low[i]] += bdd.complement_edge[i] ? -d_low : d_low;
+  }
+  std::copy_n(d.begin() + 1, bdd.num_vars, mif.begin());
+  return mif;
 }
 
 }  // namespace core
@@ -88,12 +88,15 @@ class ImportanceAnalysis : public Analysis {
   /// @returns Occurrences of basic events in products.
   virtual std::vector<int> occurrences() noexcept = 0;
 
-  /// Calculates Marginal Importance Factor.
+  /// Calculates Marginal Importance Factors of events.
   ///
-  /// @param[in] index  The position index of an event in events vector.
+  /// @param[in] occurrences  Occurrences of events in products.
   ///
-  /// @returns Calculated value for MIF.
-  virtual double CalculateMif(int index) noexcept = 0;
+  /// @returns Calculated values for MIF
+  ///          at the position indices of events in events vector.
+  ///          The values are meaningful only for events with occurrences.
+  virtual std::vector<double> CalculateMif(
+      const std::vector<int>& occurrences) noexcept = 0;
 
   /// Container of important events and their importance factors.
   std::vector<ImportanceRecord> importance_;
@@ -141,10 +144,31 @@ class ImportanceAnalyzer : public ImportanceAnalyzerBase {
         p_vars_(prob_analyzer->p_vars()) {}
 
  private:
-  double CalculateMif(int index) noexcept override;
+  std::vector<double> CalculateMif(
+      const std::vector<int>& occurrences) noexcept override;
+
+  /// Calculates Marginal Importance Factor
+  /// with conditional total probabilities of the system.
+  ///
+  /// @param[in] index  The position index of an event in events vector.
+  ///
+  /// @returns Calculated value for MIF.
+  double CalculateMif(int index) noexcept;
+
   Pdag::IndexMap<double> p_vars_;  ///< A copy of variable probabilities.
 };
 
+template <class Calculator>
+std::vector<double> ImportanceAnalyzer<Calculator>::CalculateMif(
+    const std::vector<int>& occurrences) noexcept {
+  std::vector<double> mif(occurrences.size());
+  for (int i = 0; i < occurrences.size(); ++i) {
+    if (occurrences[i])
+      mif[i] = CalculateMif(i);
+  }
+  return mif;
+}
+
 template <class Calculator>
 double ImportanceAnalyzer<Calculator>::CalculateMif(int index) noexcept {
   index += Pdag::kVariableStartIndex;
@@ -160,6 +184,12 @@ double ImportanceAnalyzer<Calculator>::CalculateMif(int index) noexcept {
 }
 
 /// Specialization of importance analyzer with Binary Decision Diagrams.
+///
+/// The marginal importance factors of all variables
+/// are the partial derivatives of the total probability,
+/// which are calculated with a single backward (adjoint) sweep
+/// over the flattened BDD and its modules
+/// after a forward sweep for the probabilities of the vertices.
 template <>
 class ImportanceAnalyzer<Bdd> : public ImportanceAnalyzerBase {
  public:
@@ -169,34 +199,14 @@ class ImportanceAnalyzer<Bdd> : public ImportanceAnalyzerBase {
   ///
   /// @param[in] prob_analyzer  Instantiated probability analyzer.
   explicit ImportanceAnalyzer(ProbabilityAnalyzer<Bdd>* prob_analyzer)
-      : ImportanceAnalyzerBase(prob_analyzer),
-        bdd_graph_(prob_analyzer->bdd_graph()) {}
+      : ImportanceAnalyzerBase(prob_analyzer) {}
 
  private:
-  double CalculateMif(int index) noexcept override;
-
-  /// Calculates Marginal Importance Factor of a variable.
-  ///
-  /// @param[in] vertex  The root vertex of a function graph.
-  /// @param[in] order  The identifying order of the variable.
-  /// @param[in] mark  A flag to mark traversed vertices.
-  ///
-  /// @returns Importance factor value.
-  ///
-  /// @note Probability factor fields are used to save results.
-  /// @note The graph needs cleaning its marks after this function
-  ///       because the graph gets continuously-but-partially marked.
-  double CalculateMif(const Bdd::VertexPtr& vertex, int order,
-                      bool mark) noexcept;
-
-  /// Retrieves memorized probability values for BDD function graphs.
-  ///
-  /// @param[in] vertex  Vertex with calculated probabilities.
-  ///
-  /// @returns Saved probability value of the vertex.
-  double RetrieveProbability(const Bdd::VertexPtr& vertex) noexcept;
+  /// The compiled BDD of the probability analyzer.
+  using FlatBdd = ProbabilityAnalyzer<Bdd>::FlatBdd;
 
-  Bdd* bdd_graph_;  ///< Binary decision diagram for the analyzer.
+  std::vector<double> CalculateMif(
+      const std::vector<int>& occurrences) noexcept override;
 };
 
 }  // namespace core
@@ -28,13 +28,16 @@
 #include "mocus.h"
 
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram {
 namespace core {
 
 Mocus::Mocus(const Pdag* graph, const Settings& settings)
     : graph_(graph),
-      kSettings_(settings) {
+      kSettings_(settings),
+      cut_off_(CutOff::Create(*graph, settings)),
+      cache_(ModuleCache::Create(*graph, settings)) {
   assert(!graph->complement() && "Complements must be propagated.");
 }
 
@@ -66,7 +69,9 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
   const int kMaxVariableIndex =
       Pdag::kVariableStartIndex + graph_->basic_events().size() - 1;
   auto container = std::make_unique<zbdd::CutSetContainer>(
-      kSettings_, gate.index(), kMaxVariableIndex);
+      kSettings_, gate.index(), kMaxVariableIndex, cut_off_, cache_);
+  if (container->LoadModule(gate))
+    return container;
   container->Merge(container->ConvertGate(gate));
   while (int next_gate_index = container->GetNextGate()) {
     LOG(DEBUG5) << "Expanding gate G" << next_gate_index;
@@ -85,6 +90,7 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
     container->EliminateComplements();
     container->Minimize();
   }
+  std::vector<std::pair<int, int>> modules;  // Modules to analyze with limits.
   for (const auto& entry : container->GatherModules()) {
     int index = entry.first;
     assert(index > 0 && "No complement modules are expected.");
@@ -97,11 +103,19 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
       container->JoinModule(index, std::move(empty_zbdd));
       continue;
     }
-    Settings adjusted(settings);
-    adjusted.limit_order(limit);
-    container->JoinModule(index,
-                          AnalyzeModule(*gates.find(index)->second, adjusted));
+    modules.emplace_back(index, limit);
   }
+  // The PDAG is only read by the analysis of independent modules.
+  int num_threads = settings.num_threads();
+  std::vector<std::unique_ptr<zbdd::CutSetContainer>> results(modules.size());
+  ParallelFor(num_threads, modules.size(), [&](int i) {
+    Settings adjusted(settings);
+    adjusted.limit_order(modules[i].second);
+    adjusted.num_threads(std::max<int>(1, num_threads / modules.size()));
+    results[i] = AnalyzeModule(*gates.find(modules[i].first)->second, adjusted);
+  });
+  for (int i = 0; i < modules.size(); ++i)
+    container->JoinModule(modules[i].first, std::move(results[i]));
   container->EliminateConstantModules();
   container->Minimize();
   return container;
@@ -74,6 +74,8 @@ class Mocus : private boost::noncopyable {
 
   const Pdag* graph_;  ///< The analysis PDAG.
   const Settings kSettings_;  ///< Analysis settings.
+  std::shared_ptr<const CutOff> cut_off_;  ///< The probability cut-off.
+  std::shared_ptr<const ModuleCache> cache_;  ///< The cache of module cut sets.
   std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
 };
 
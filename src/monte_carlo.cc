@@ -0,0 +1,375 @@
+/*
+ * Copyright (C) 2014-2017 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file monte_carlo.cc
+/// Implementation of the bit-parallel Monte Carlo simulation.
+
+#include "monte_carlo.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <bitset>
+#include <numeric>
+#include <string>
+
+#include "event.h"
+#include "expression_tape.h"
+#include "logger.h"
+#include "parallel.h"
+#include "parameter.h"
+#include "preprocessor.h"
+#include "random.h"
+
+namespace scram {
+namespace core {
+
+namespace {
+
+/// The number of trials standing for no more occurrences.
+const std::int64_t kNever = std::int64_t(1) << 62;
+
+/// The smallest probability of the less probable state
+/// to sample its trials word by word instead of the geometric jumps.
+const double kDenseProbability = 1.0 / 8;
+
+/// Samples the number of trials before the next occurrence of an event,
+/// i.e., the geometric distribution by inversion.
+///
+/// @param[in] log_q  The logarithm of the complement of the event probability.
+///
+/// @returns The number of trials without the event.
+std::int64_t SampleGap(double log_q) noexcept {
+  double gap = std::log(1 - Random::UniformRealGenerator(0, 1)) / log_q;
+  return gap < kNever ? static_cast<std::int64_t>(gap) : kNever;
+}
+
+/// Samples a word of trials with an event probability in fixed point,
+/// i.e., the fraction of 2^32.
+/// The bits of the probability from the least significant one
+/// select OR or AND with uniformly random words,
+/// each step averaging the probability of true bits with 1 or 0.
+///
+/// @param[in] fraction  The nonzero probability numerator.
+///
+/// @returns The word with the true bits for event occurrences.
+MonteCarlo::Word SampleWord(std::uint32_t fraction) noexcept {
+  int num_steps = 32;
+  for (; !(fraction & 1); fraction >>= 1)
+    --num_steps;  // The trailing zero steps keep the word empty.
+  MonteCarlo::Word bits = 0;
+  for (; num_steps; --num_steps, fraction >>= 1) {
+    if (fraction & 1) {
+      bits |= Random::BitGenerator();
+    } else {
+      bits &= Random::BitGenerator();
+    }
+  }
+  return bits;
+}
+
+/// @returns The slot argument encoded with the complement flag.
+int Encode(int slot, bool complement) { return slot << 1 | complement; }
+
+}  // namespace
+
+const int MonteCarlo::kWordSize;
+const int MonteCarlo::kNumWords;
+const int MonteCarlo::kBlockSize;
+
+MonteCarlo::MonteCarlo(const Pdag* graph) noexcept
+    : num_vars_(graph->basic_events().size()), max_vote_number_(0) {
+  TIMER(DEBUG3, "Compiling PDAG for simulation");
+  std::unordered_map<int, int> slots;
+  root_ = Encode(Compile(graph->root(), &slots), graph->complement());
+  LOG(DEBUG4) << "# of gate instructions: " << instructions_.size();
+}
+
+int MonteCarlo::Compile(const Gate& gate,
+                        std::unordered_map<int, int>* slots) noexcept {
+  auto it = slots->find(gate.index());
+  if (it != slots->end())
+    return it->second;
+  std::vector<int> args;
+  if (gate.constant())
+    args.push_back(Encode(0, *gate.args().begin() < 0));
+  for (const auto& arg : gate.args<Gate>())
+    args.push_back(Encode(Compile(arg.second, slots), arg.first < 0));
+  for (const auto& arg : gate.args<Variable>()) {
+    int slot = 1 + arg.second.index() - Pdag::kVariableStartIndex;
+    args.push_back(Encode(slot, arg.first < 0));
+  }
+  Instruction instruction{gate.type(), 0, static_cast<int>(args_.size()),
+                          static_cast<int>(args.size())};
+  if (gate.constant()) {
+    instruction.type = kNull;
+  } else if (gate.type() == kVote) {
+    instruction.vote_number = gate.vote_number();
+    max_vote_number_ = std::max(max_vote_number_, gate.vote_number());
+  }
+  args_.insert(args_.end(), args.begin(), args.end());
+  int slot = 1 + num_vars_ + instructions_.size();
+  instructions_.push_back(instruction);
+  slots->emplace(gate.index(), slot);
+  return slot;
+}
+
+void MonteCarlo::Evaluate(const Instruction& instruction, const Word* values,
+                          Word* counters, Word* result) const noexcept {
+  // The complement is applied as XOR with the mask of the argument.
+  const int* args = args_.data() + instruction.first_arg;
+  auto value = [values](int arg) { return values + (arg >> 1) * kNumWords; };
+  auto mask = [](int arg) { return Word(0) - (arg & 1); };
+  switch (instruction.type) {
+    case kAnd:
+    case kNand:
+    case kNull:
+      std::fill_n(result, kNumWords, ~Word(0));
+      for (int i = 0; i < instruction.num_args; ++i) {
+        const Word* arg = value(args[i]);
+        Word arg_mask = mask(args[i]);
+        for (int j = 0; j < kNumWords; ++j)
+          result[j] &= arg[j] ^ arg_mask;
+      }
+      break;
+    case kOr:
+    case kNor:
+    case kNot:
+      std::fill_n(result, kNumWords, Word(0));
+      for (int i = 0; i < instruction.num_args; ++i) {
+        const Word* arg = value(args[i]);
+        Word arg_mask = mask(args[i]);
+        for (int j = 0; j < kNumWords; ++j)
+          result[j] |= arg[j] ^ arg_mask;
+      }
+      break;
+    case kXor:
+      std::fill_n(result, kNumWords, Word(0));
+      for (int i = 0; i < instruction.num_args; ++i) {
+        const Word* arg = value(args[i]);
+        Word arg_mask = mask(args[i]);
+        for (int j = 0; j < kNumWords; ++j)
+          result[j] ^= arg[j] ^ arg_mask;
+      }
+      break;
+    case kVote: {
+      // The counter k holds the trials with at least k true arguments.
+      int vote_number = instruction.vote_number;
+      std::fill_n(counters, kNumWords, ~Word(0));
+      std::fill_n(counters + kNumWords, vote_number * kNumWords, Word(0));
+      for (int i = 0; i < instruction.num_args; ++i) {
+        const Word* arg = value(args[i]);
+        Word arg_mask = mask(args[i]);
+        for (int k = std::min(vote_number, i + 1); k > 0; --k) {
+          Word* at_least = counters + k * kNumWords;
+          const Word* at_least_less = at_least - kNumWords;
+          for (int j = 0; j < kNumWords; ++j)
+            at_least[j] |= at_least_less[j] & (arg[j] ^ arg_mask);
+        }
+      }
+      std::copy_n(counters + vote_number * kNumWords, kNumWords, result);
+      break;
+    }
+  }
+  if (instruction.type == kNand || instruction.type == kNor ||
+      instruction.type == kNot) {
+    for (int j = 0; j < kNumWords; ++j)
+      result[j] = ~result[j];
+  }
+}
+
+std::int64_t MonteCarlo::Simulate(const Pdag::IndexMap<double>& p_vars,
+                                  std::int64_t num_trials) const noexcept {
+  /// The variable sampler of the less probable state.
+  /// Rare states are sampled with geometric jumps between their trials,
+  /// and frequent states are sampled bit-parallel word by word.
+  struct Sampler {
+    bool invert;  ///< The indication that the true state is more probable.
+    std::uint32_t fraction;  ///< The probability for words (0 for jumps).
+    double log_q;  ///< The logarithm of the more probable state probability.
+    std::int64_t next;  ///< The next trial with the less probable state.
+  };
+  std::vector<Sampler> samplers;
+  samplers.reserve(num_vars_);
+  for (double p : p_vars) {
+    bool invert = p > 0.5;
+    double q = invert ? 1 - p : p;
+    if (q >= kDenseProbability) {
+      auto fraction = static_cast<std::uint32_t>(std::ldexp(q, 32));
+      samplers.push_back({invert, fraction, 0, kNever});
+    } else {
+      double log_q = std::log1p(-q);
+      samplers.push_back({invert, 0, log_q, q ? SampleGap(log_q) : kNever});
+    }
+  }
+
+  int first_gate = 1 + num_vars_;
+  std::vector<Word> values((first_gate + instructions_.size()) * kNumWords);
+  std::fill_n(values.begin(), kNumWords, ~Word(0));  // The constant TRUE.
+  std::vector<Word> counters((max_vote_number_ + 1) * kNumWords);
+  const Word* root = values.data() + (root_ >> 1) * kNumWords;
+  Word root_mask = Word(0) - (root_ & 1);
+  std::int64_t count = 0;
+  for (std::int64_t first = 0; first < num_trials; first += kBlockSize) {
+    Word* bits = values.data() + kNumWords;
+    for (Sampler& sampler : samplers) {
+      if (sampler.fraction) {
+        for (int j = 0; j < kNumWords; ++j)
+          bits[j] = SampleWord(sampler.fraction);
+      } else {
+        std::fill_n(bits, kNumWords, Word(0));
+      }
+      for (; sampler.next < kBlockSize;
+           sampler.next += 1 + SampleGap(sampler.log_q)) {
+        bits[sampler.next / kWordSize] |= Word(1)
+                                          << (sampler.next % kWordSize);
+      }
+      sampler.next -= kBlockSize;
+      if (sampler.invert) {
+        for (int j = 0; j < kNumWords; ++j)
+          bits[j] = ~bits[j];
+      }
+      bits += kNumWords;
+    }
+    Word* result = values.data() + first_gate * kNumWords;
+    for (const Instruction& instruction : instructions_) {
+      Evaluate(instruction, values.data(), counters.data(), result);
+      result += kNumWords;
+    }
+    std::int64_t num_left = num_trials - first;
+    for (int j = 0; j < kNumWords && j * kWordSize < num_left; ++j) {
+      Word occurrences = root[j] ^ root_mask;
+      if (num_left - j * kWordSize < kWordSize)  // The partial last word.
+        occurrences &= (Word(1) << (num_left - j * kWordSize)) - 1;
+      count += std::bitset<kWordSize>(occurrences).count();
+    }
+  }
+  return count;
+}
+
+const int MonteCarloAnalyzer::kChunkSize;
+
+MonteCarloAnalyzer::MonteCarloAnalyzer(const mef::Gate& root,
+                                       const Settings& settings,
+                                       mef::MissionTime* mission_time)
+    : ProbabilityAnalysis(settings, mission_time),
+      target_(Random::target()),
+      standard_error_(0),
+      confidence_interval_(0, 1) {
+  CLOCK(graph_time);
+  graph_ = std::make_unique<Pdag>(root, Analysis::settings().ccf_analysis());
+  CustomPreprocessor<MonteCarlo>{graph_.get()}();
+  simulator_ = std::make_unique<MonteCarlo>(graph_.get());
+  Analysis::AddAnalysisTime(DUR(graph_time));
+  if (Analysis::settings().importance_analysis() ||
+      Analysis::settings().uncertainty_analysis()) {
+    Analysis::AddWarning(
+        "Importance and uncertainty analyses require products");
+  }
+  if (Analysis::settings().time_step() &&
+      Analysis::settings().time_tolerance()) {
+    // The sampling noise would drive the refinement of the time steps.
+    Analysis::AddWarning("Monte Carlo uses fixed time steps without tolerance");
+  }
+}
+
+double MonteCarloAnalyzer::CalculateTotalProbability() noexcept {
+  double n = num_trials();
+  std::int64_t count = Simulate(ExtractVariableProbabilities());
+  double p_total = count / n;
+  standard_error_ = std::sqrt(p_total * (1 - p_total) / n);
+  // The Wilson score interval stays informative for rare events
+  // with few or no occurrences in the trials.
+  const double z = 1.959963984540054;  // The 97.5% standard normal quantile.
+  double z2 = z * z;
+  double center = (count + z2 / 2) / (n + z2);
+  double half = z / (n + z2) * std::sqrt(count * (n - count) / n + z2 / 4);
+  confidence_interval_ = {std::max(0.0, center - half),
+                          std::min(1.0, center + half)};
+  if (!count)
+    Analysis::AddWarning("No top event occurrences in the trials");
+  return p_total;
+}
+
+std::vector<std::pair<double, double>>
+MonteCarloAnalyzer::CalculateProbabilityOverTime() noexcept {
+  std::vector<std::pair<double, double>> p_time;
+  double time_step = Analysis::settings().time_step();
+  if (!time_step)
+    return p_time;
+
+  // Only the time-dependent probabilities are re-evaluated at each point.
+  Pdag::IndexMap<double> p_vars = ExtractVariableProbabilities();
+  std::vector<int> time_dependent_vars;
+  std::vector<mef::Expression*> expressions;
+  int index = Pdag::kVariableStartIndex;
+  for (const mef::BasicEvent* event : graph_->basic_events()) {
+    if (event->expression().IsTimeDependent()) {
+      time_dependent_vars.push_back(index);
+      expressions.push_back(&event->expression());
+    }
+    ++index;
+  }
+  const mef::ExpressionTape tape(expressions);
+  std::vector<double> p_time_vars(tape.size());
+
+  // The same random streams are reused for all the time points
+  // to correlate the estimates into a smoother curve.
+  double total_time = ProbabilityAnalysis::mission_time().value();
+  double n = num_trials();
+  mef::MissionTime::ThreadValue thread_time(&mission_time());
+  auto simulate = [&](double time) {
+    mission_time().value(time);
+    tape.Evaluate(p_time_vars.data());
+    for (int i = 0; i < time_dependent_vars.size(); ++i)
+      p_vars[time_dependent_vars[i]] = p_time_vars[i];
+    return Simulate(p_vars) / n;
+  };
+  for (double time = 0; time < total_time; time += time_step)
+    p_time.emplace_back(simulate(time), time);
+  p_time.emplace_back(simulate(total_time), total_time);
+  return p_time;
+}
+
+Pdag::IndexMap<double> MonteCarloAnalyzer::ExtractVariableProbabilities() const
+    noexcept {
+  std::vector<mef::Expression*> expressions;
+  expressions.reserve(graph_->basic_events().size());
+  for (const mef::BasicEvent* event : graph_->basic_events())
+    expressions.push_back(&event->expression());
+  mef::ExpressionTape tape(expressions);
+  Pdag::IndexMap<double> p_vars(tape.size());
+  tape.Evaluate(p_vars.data());
+  return p_vars;
+}
+
+std::int64_t MonteCarloAnalyzer::Simulate(
+    const Pdag::IndexMap<double>& p_vars) noexcept {
+  std::int64_t num_trials = this->num_trials();
+  int num_chunks = (num_trials + kChunkSize - 1) / kChunkSize;
+  std::vector<std::int64_t> counts(num_chunks);
+  ParallelFor(Analysis::settings().num_threads(), num_chunks, [&](int chunk) {
+    Random::stream(target_, chunk);  // Independent of the thread.
+    std::int64_t first = std::int64_t(chunk) * kChunkSize;
+    counts[chunk] = simulator_->Simulate(
+        p_vars, std::min<std::int64_t>(kChunkSize, num_trials - first));
+  });
+  return std::accumulate(counts.begin(), counts.end(), std::int64_t(0));
+}
+
+}  // namespace core
+}  // namespace scram
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2014-2017 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file monte_carlo.h
+/// Probability analysis with bit-parallel Monte Carlo simulation of PDAG.
+
+#ifndef SCRAM_SRC_MONTE_CARLO_H_
+#define SCRAM_SRC_MONTE_CARLO_H_
+
+#include <cstdint>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pdag.h"
+#include "probability_analysis.h"
+#include "settings.h"
+
+namespace scram {
+
+namespace mef {  // Decouple from the analysis code.
+class Gate;
+class MissionTime;
+}  // namespace mef
+
+namespace core {
+
+/// Monte Carlo simulator of a preprocessed PDAG.
+/// The states of variables are sampled as bit vectors,
+/// where every bit is an independent trial,
+/// and the gates are evaluated with bitwise operations
+/// for a block of trials at once.
+///
+/// The gates are compiled upon construction
+/// into instructions in the topological order (arguments first),
+/// so the simulation is a single pass over the instructions per block
+/// without modifying the graph.
+class MonteCarlo {
+ public:
+  using Word = std::uint64_t;  ///< The bit vector of trials.
+  static const int kWordSize = 64;  ///< The number of trials in a word.
+  /// The number of words evaluated together
+  /// for the word loops to get vectorized.
+  static const int kNumWords = 4;
+  /// The number of trials in a block of words.
+  static const int kBlockSize = kWordSize * kNumWords;
+
+  /// @param[in] graph  The PDAG preprocessed for Monte Carlo simulation.
+  explicit MonteCarlo(const Pdag* graph) noexcept;
+
+  /// Simulates trials with the random numbers of the current thread.
+  ///
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  /// @param[in] num_trials  The number of trials to simulate.
+  ///
+  /// @returns The number of trials with the occurrence of the top event.
+  ///
+  /// @note This function is safe to call concurrently.
+  std::int64_t Simulate(const Pdag::IndexMap<double>& p_vars,
+                        std::int64_t num_trials) const noexcept;
+
+ private:
+  /// Gate compiled for evaluation.
+  /// The arguments are slots of values
+  /// encoded with the complement flag in the lowest bit.
+  /// The slots are
+  /// the Boolean constant (slot 0),
+  /// the variables in the order of indices,
+  /// and the gate instructions.
+  struct Instruction {
+    Operator type;  ///< The logic of the gate.
+    int vote_number;  ///< The vote number for K/N gates.
+    int first_arg;  ///< The position of the first argument.
+    int num_args;  ///< The number of arguments.
+  };
+
+  /// Compiles the gate and its arguments into instructions.
+  ///
+  /// @param[in] gate  The gate to compile.
+  /// @param[in,out] slots  The slots of compiled gates by indices.
+  ///
+  /// @returns The slot of the gate.
+  int Compile(const Gate& gate, std::unordered_map<int, int>* slots) noexcept;
+
+  /// Evaluates an instruction for a block of trials.
+  ///
+  /// @param[in] instruction  The gate instruction.
+  /// @param[in] values  The block values of slots.
+  /// @param[out] counters  The scratch space for K/N gate vote counters.
+  /// @param[out] result  The block values of the gate.
+  void Evaluate(const Instruction& instruction, const Word* values,
+                Word* counters, Word* result) const noexcept;
+
+  int num_vars_;  ///< The number of variables.
+  int root_;  ///< The encoded root argument.
+  int max_vote_number_;  ///< The vote number for the counter space.
+  std::vector<Instruction> instructions_;  ///< The compiled gates.
+  std::vector<int> args_;  ///< The encoded arguments of instructions.
+};
+
+/// Probability analysis with Monte Carlo simulation
+/// for models where the qualitative analysis does not complete.
+/// The PDAG of the fault tree is preprocessed and simulated directly
+/// without generating the products.
+class MonteCarloAnalyzer : public ProbabilityAnalysis {
+ public:
+  /// The number of trials simulated with the same random stream.
+  /// The trials are split into chunks independent of the number of threads.
+  static const int kChunkSize = 1 << 16;
+
+  /// Constructs and preprocesses the PDAG of the fault tree.
+  ///
+  /// @param[in] root  The top event of the fault tree to simulate.
+  /// @param[in] settings  Analysis settings with the number of trials.
+  /// @param[in] mission_time  The mission time expression of the model.
+  MonteCarloAnalyzer(const mef::Gate& root, const Settings& settings,
+                     mef::MissionTime* mission_time);
+
+  /// @returns The number of simulated trials.
+  int num_trials() const { return Analysis::settings().monte_carlo(); }
+
+  /// @returns The standard error of the total probability estimate.
+  ///
+  /// @pre The analysis is done.
+  double standard_error() const { return standard_error_; }
+
+  /// @returns The 95% confidence interval of the total probability.
+  ///
+  /// @pre The analysis is done.
+  const std::pair<double, double>& confidence_interval() const {
+    return confidence_interval_;
+  }
+
+ private:
+  double CalculateTotalProbability() noexcept override;
+
+  std::vector<std::pair<double, double>>
+  CalculateProbabilityOverTime() noexcept override;
+
+  /// @returns The current probabilities of the graph variables.
+  Pdag::IndexMap<double> ExtractVariableProbabilities() const noexcept;
+
+  /// Simulates all the trials in chunks shared by threads.
+  ///
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns The number of trials with the occurrence of the top event.
+  std::int64_t Simulate(const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  std::unique_ptr<Pdag> graph_;  ///< The preprocessed PDAG of the fault tree.
+  std::unique_ptr<const MonteCarlo> simulator_;  ///< The compiled simulator.
+  int target_;  ///< The random stream target of the analysis.
+  double standard_error_;  ///< The standard error of the estimate.
+  std::pair<double, double> confidence_interval_;  ///< The 95% interval.
+};
+
+}  // namespace core
+}  // namespace scram
+
+#endif  // SCRAM_SRC_MONTE_CARLO_H_
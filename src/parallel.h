@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2017 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file parallel.h
+/// Helpers to run independent tasks in parallel threads.
+
+#ifndef SCRAM_SRC_PARALLEL_H_
+#define SCRAM_SRC_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace scram {
+namespace core {
+
+/// Runs independent tasks on a pool of threads.
+/// Idle threads pick up the next task in the order of task indices.
+/// The calling thread is one of the threads in the pool.
+///
+/// @tparam Task  The callable with the task index argument.
+///
+/// @param[in] num_threads  The maximum number of threads to use.
+/// @param[in] num_tasks  The number of tasks.
+/// @param[in] task  The thread-safe task to run for each index.
+///
+/// @note The tasks are run in the calling thread in order
+///       if only one thread is requested.
+template <class Task>
+void ParallelFor(int num_threads, int num_tasks, const Task& task) noexcept {
+  num_threads = std::min(num_threads, num_tasks);
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_tasks; ++i)
+      task(i);
+    return;
+  }
+  std::atomic<int> next_task(0);
+  auto worker = [&next_task, num_tasks, &task] {
+    for (int i = next_task++; i < num_tasks; i = next_task++)
+      task(i);
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+/// A pool of threads for the fork-join parallelism of recursive computations.
+/// The forked tasks wait in a shared queue
+/// until an idle thread takes them (the oldest first)
+/// or the forking thread joins them back.
+/// The threads waiting for their taken tasks
+/// help with the latest tasks in the queue,
+/// so nested forks do not deadlock with more tasks than threads.
+class TaskPool : private boost::noncopyable {
+ public:
+  /// A forked computation in the memory of the forking thread.
+  class Task : private boost::noncopyable {
+    friend class TaskPool;
+
+   public:
+    /// @param[in] run  The computation to run once.
+    explicit Task(std::function<void()> run) noexcept
+        : run_(std::move(run)),
+          done_(false) {}
+
+   private:
+    std::function<void()> run_;  ///< The computation.
+    bool done_;  ///< The indication of the completion by another thread.
+  };
+
+  /// Starts the threads of the pool.
+  ///
+  /// @param[in] num_threads  The number of threads including the caller.
+  explicit TaskPool(int num_threads) : stop_(false) {
+    for (int i = 1; i < num_threads; ++i)
+      threads_.emplace_back([this] { Work(); });
+  }
+
+  /// Stops and joins the threads of the pool.
+  ~TaskPool() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    task_ready_.notify_all();
+    for (std::thread& thread : threads_)
+      thread.join();
+  }
+
+  /// @returns The number of threads including the caller.
+  int num_threads() const { return threads_.size() + 1; }
+
+  /// Queues a task for any thread in the pool.
+  ///
+  /// @param[in] task  The task to be joined by the caller.
+  void Fork(Task* task) noexcept {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(task);
+    }
+    task_ready_.notify_one();
+  }
+
+  /// Waits for the completion of a forked task.
+  /// The task is run by the caller if no other thread has taken it.
+  ///
+  /// @param[in] task  The task forked by the caller.
+  void Join(Task* task) noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::find(queue_.rbegin(), queue_.rend(), task);
+    if (it != queue_.rend()) {  // Likely the latest task.
+      queue_.erase(std::next(it).base());
+      lock.unlock();
+      task->run_();
+      return;
+    }
+    while (!task->done_) {
+      if (queue_.empty()) {
+        task_done_.wait(lock);
+        continue;
+      }
+      Task* other = queue_.back();
+      queue_.pop_back();
+      Run(other, &lock);
+    }
+  }
+
+ private:
+  /// Runs a task taken from the queue and notifies the joining threads.
+  ///
+  /// @param[in] task  The task out of the queue.
+  /// @param[in,out] lock  The lock of the queue to release while running.
+  void Run(Task* task, std::unique_lock<std::mutex>* lock) noexcept {
+    lock->unlock();
+    task->run_();
+    lock->lock();
+    task->done_ = true;
+    task_done_.notify_all();
+  }
+
+  /// Runs the oldest tasks in the queue until the pool stops.
+  void Work() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      task_ready_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (stop_)
+        return;
+      Task* task = queue_.front();
+      queue_.pop_front();
+      Run(task, &lock);
+    }
+  }
+
+  std::mutex mutex_;  ///< The lock of the queue and the task states.
+  std::condition_variable task_ready_;  ///< The queue is not empty.
+  std::condition_variable task_done_;  ///< A taken task is complete.
+  std::deque<Task*> queue_;  ///< The tasks waiting for threads.
+  bool stop_;  ///< The request to stop the threads.
+  std::vector<std::thread> threads_;  ///< The threads besides the caller.
+};
+
+}  // namespace core
+}  // namespace scram
+
+#endif  // SCRAM_SRC_PARALLEL_H_
@@ -25,6 +25,19 @@
 namespace scram {
 namespace mef {
 
+thread_local MissionTime::ThreadValue* MissionTime::thread_value_ = nullptr;
+
+MissionTime::ThreadValue::ThreadValue(MissionTime* mission_time) noexcept
+    : mission_time_(mission_time),
+      value_(mission_time->value()),
+      previous_(thread_value_) {
+  thread_value_ = this;
+}
+
+MissionTime::ThreadValue::~ThreadValue() noexcept {
+  thread_value_ = previous_;
+}
+
 MissionTime::MissionTime(double time, Units unit)
     : unit_(unit),
       value_(time) {
@@ -34,7 +47,11 @@ MissionTime::MissionTime(double time, Units unit)
 void MissionTime::value(double time) {
   if (time < 0)
     SCRAM_THROW(LogicError("Mission time cannot be negative."));
-  value_ = time;
+  if (thread_value_ && thread_value_->mission_time_ == this) {
+    thread_value_->value_ = time;
+  } else {
+    value_ = time;
+  }
 }
 
 void Parameter::expression(Expression* expression) {
@@ -56,6 +56,27 @@ const char* const kUnitsToString[] = {"unitless", "bool",    "int",   "float",
 /// The special parameter for system mission time.
 class MissionTime : public Expression {
  public:
+  /// Mission time value private to the current thread.
+  /// While an object of this class is alive,
+  /// the changes of the mission time in the thread
+  /// are not visible to other threads.
+  class ThreadValue : private boost::noncopyable {
+   public:
+    /// Starts with the current value of the mission time.
+    ///
+    /// @param[in] mission_time  The mission time to privatize.
+    explicit ThreadValue(MissionTime* mission_time) noexcept;
+
+    /// Restores the previous mission time value of the thread.
+    ~ThreadValue() noexcept;
+
+   private:
+    friend class MissionTime;
+    const MissionTime* mission_time_;  ///< The privatized mission time.
+    double value_;  ///< The private value.
+    ThreadValue* previous_;  ///< The enclosing private value if any.
+  };
+
   /// @param[in] time  The mission time.
   /// @param[in] unit  The unit of the given ``time`` argument.
   ///
@@ -70,17 +91,30 @@ class MissionTime : public Expression {
   /// @param[in] time  The mission time in hours.
   ///
   /// @throws LogicError  The time value is negative.
+  ///
+  /// @note The change is private to the current thread
+  ///       if the thread has an active ThreadValue of this mission time.
   void value(double time);
 
-  double value() noexcept override { return value_; }
-  Interval interval() noexcept override { return Interval::closed(0, value_); }
+  double value() noexcept override {
+    return thread_value_ && thread_value_->mission_time_ == this
+               ? thread_value_->value_
+               : value_;
+  }
+  Interval interval() noexcept override {
+    return Interval::closed(0, value());
+  }
   bool IsDeviate() noexcept override { return false; }
+  bool IsTimeDependent() noexcept override { return true; }
 
  private:
-  double DoSample() noexcept override { return value_; }
+  double DoSample() noexcept override { return value(); }
 
   Units unit_;  ///< Units of this parameter.
   double value_;  ///< The universal value to represent int, bool, double.
+
+  /// The mission time value private to the current thread if any.
+  static thread_local ThreadValue* thread_value_;
 };
 
 /// This class provides a representation of a variable
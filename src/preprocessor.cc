@@ -361,13 +361,13 @@ void Preprocessor::RunPhaseTwo() noexcept {
   graph_->Log();
 }
 
-void Preprocessor::RunPhaseThree() noexcept {
+void Preprocessor::RunPhaseThree(bool keep_complex_gates) noexcept {
   TIMER(DEBUG2, "Preprocessing Phase III");
   SANITY_ASSERT;
   graph_->Log();
   assert(!graph_->normal());
-  NormalizeGates(/*full=*/true);
-  graph_->normal(true);
+  NormalizeGates(/*full=*/true, keep_complex_gates);
+  graph_->normal(!keep_complex_gates);
 
   if (graph_->IsTrivial())
     return;
@@ -478,7 +478,7 @@ bool IsSubgraphWithinGraph(const GatePtr& root, int enter_time,
 
 }  // namespace
 
-void Preprocessor::NormalizeGates(bool full) noexcept {
+void Preprocessor::NormalizeGates(bool full, bool keep_complex_gates) noexcept {
   TIMER(DEBUG3, (full ? "Full normalization" : "Partial normalization"));
   assert(!graph_->HasNullGates());
   if (full)
@@ -503,7 +503,8 @@ void Preprocessor::NormalizeGates(bool full) noexcept {
   NotifyParentsOfNegativeGates(root_gate);
 
   graph_->Clear<Pdag::kGateMark>();
-  NormalizeGate(root_gate, full);  // Registers null gates only.
+  // Registers null gates only.
+  NormalizeGate(root_gate, full, keep_complex_gates);
 
   assert(!graph_->HasConstants());
   graph_->RemoveNullGates();
@@ -519,7 +520,8 @@ void Preprocessor::NotifyParentsOfNegativeGates(const GatePtr& gate) noexcept {
   }
 }
 
-void Preprocessor::NormalizeGate(const GatePtr& gate, bool full) noexcept {
+void Preprocessor::NormalizeGate(const GatePtr& gate, bool full,
+                                 bool keep_complex_gates) noexcept {
   if (gate->mark())
     return;
   gate->mark(true);
@@ -527,7 +529,7 @@ void Preprocessor::NormalizeGate(const GatePtr& gate, bool full) noexcept {
   assert(!gate->args().empty());
   // Depth-first traversal before the arguments may get changed.
   for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
-    NormalizeGate(arg.second, full);
+    NormalizeGate(arg.second, full, keep_complex_gates);
   }
 
   switch (gate->type()) {  // Negation is already processed.
@@ -541,13 +543,13 @@ void Preprocessor::NormalizeGate(const GatePtr& gate, bool full) noexcept {
       break;
     case kXor:
       assert(gate->args().size() == 2);
-      if (full)
+      if (full && !keep_complex_gates)
         NormalizeXorGate(gate);
       break;
     case kVote:
       assert(gate->args().size() > 2);
       assert(gate->vote_number() > 1);
-      if (full)
+      if (full && !keep_complex_gates)
         NormalizeVoteGate(gate);
       break;
     case kNot:
@@ -2382,8 +2384,13 @@ void Preprocessor::GatherNodes(const GatePtr& gate,
 }
 
 void CustomPreprocessor<Bdd>::Run() noexcept {
-  Preprocessor::Run();
-  pdag::Transform(graph_, &pdag::MarkCoherence, &pdag::TopologicalOrder);
+  pdag::Transform(graph_, [this](Pdag*) { RunPhaseOne(); },
+                  [this](Pdag*) { RunPhaseTwo(); },
+                  [this](Pdag*) {
+                    if (!graph_->normal())
+                      RunPhaseThree(/*keep_complex_gates=*/true);
+                  },
+                  &pdag::MarkCoherence, &pdag::TopologicalOrder);
 }
 
 void CustomPreprocessor<Zbdd>::Run() noexcept {
@@ -151,10 +151,14 @@ class Preprocessor : private boost::noncopyable {
 
   /// Application of gate normalization.
   /// After this phase,
-  /// the graph is in normal form.
+  /// the graph is in normal form
+  /// unless XOR and K/N gates are kept.
+  ///
+  /// @param[in] keep_complex_gates  A flag to leave XOR and K/N gates intact
+  ///                                for analyses that handle them natively.
   ///
   /// @note Gate normalization is conducted.
-  void RunPhaseThree() noexcept;
+  void RunPhaseThree(bool keep_complex_gates = false) noexcept;
 
   /// Propagation of complements.
   /// Complements are propagated down to the variables in the graph.
@@ -177,6 +181,8 @@ class Preprocessor : private boost::noncopyable {
   /// @param[in] full  A flag to handle complex gates like XOR and K/N,
   ///                  which generate a lot more new gates
   ///                  and make the structure of the graph more complex.
+  /// @param[in] keep_complex_gates  A flag to leave XOR and K/N gates
+  ///                                upon the full normalization.
   ///
   /// @note The negation of the top gate is saved
   ///       and handled as a special case for negation propagation
@@ -189,7 +195,7 @@ class Preprocessor : private boost::noncopyable {
   /// @warning Gate marks are used.
   /// @warning Node ordering may be used for full normalization.
   /// @warning Node visit information is used.
-  void NormalizeGates(bool full) noexcept;
+  void NormalizeGates(bool full, bool keep_complex_gates = false) noexcept;
 
   /// Notifies all parents of negative gates,
   /// such as NOT, NOR, and NAND,
@@ -211,6 +217,7 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @param[in,out] gate  The gate to be processed.
   /// @param[in] full  A flag to handle complex gates like XOR and K/N.
+  /// @param[in] keep_complex_gates  A flag to leave XOR and K/N gates intact.
   ///
   /// @note This is a helper function for NormalizeGates().
   ///
@@ -219,7 +226,8 @@ class Preprocessor : private boost::noncopyable {
   /// @warning Gate marks must be clear.
   /// @warning The parents of negative gates are assumed to be
   ///          notified about the change of their arguments' types.
-  void NormalizeGate(const GatePtr& gate, bool full) noexcept;
+  void NormalizeGate(const GatePtr& gate, bool full,
+                     bool keep_complex_gates) noexcept;
 
   /// Normalizes a gate with XOR logic.
   /// This is a helper function
@@ -1018,10 +1026,24 @@ class CustomPreprocessor<Bdd> : public Preprocessor {
 
  private:
   /// Performs preprocessing for analyses with Binary Decision Diagrams.
+  /// XOR and K/N gates are not normalized
+  /// because BDD constructs their functions directly.
   /// This preprocessing assigns the order for variables for BDD construction.
   void Run() noexcept override;
 };
 
+class MonteCarlo;
+
+/// Specialization of preprocessing for Monte Carlo simulations.
+/// The simulation evaluates the same gates as the BDD construction
+/// (AND, OR, K/N, XOR with complemented arguments)
+/// in the topological order.
+template <>
+class CustomPreprocessor<MonteCarlo> : public CustomPreprocessor<Bdd> {
+ public:
+  using CustomPreprocessor<Bdd>::CustomPreprocessor;
+};
+
 class Zbdd;
 
 /// Specialization of preprocessing for ZBDD based analyses.
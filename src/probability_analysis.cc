@@ -21,10 +21,16 @@
 
 #include "probability_analysis.h"
 
+#include <cmath>
+
+#include <algorithm>
+
 #include <boost/range/algorithm/find_if.hpp>
 
 #include "event.h"
+#include "expression_tape.h"
 #include "logger.h"
+#include "parallel.h"
 #include "parameter.h"
 #include "settings.h"
 #include "zbdd.h"
@@ -34,7 +40,11 @@ namespace core {
 
 ProbabilityAnalysis::ProbabilityAnalysis(const FaultTreeAnalysis* fta,
                                          mef::MissionTime* mission_time)
-    : Analysis(fta->settings()),
+    : ProbabilityAnalysis(fta->settings(), mission_time) {}
+
+ProbabilityAnalysis::ProbabilityAnalysis(const Settings& settings,
+                                         mef::MissionTime* mission_time)
+    : Analysis(settings),
       p_total_(0),
       mission_time_(mission_time) {}
 
@@ -62,6 +72,9 @@ namespace {  // Integration primitives.
 /// Ordered points in ascending X.
 using Points = std::vector<std::pair<double, double>>;
 
+/// The smallest adaptive time step as a fraction of the time step.
+const double kMinTimeStep = 1.0 / (1 << 20);
+
 /// Integrates over <y, x> points.
 double Integrate(const Points& points) {
   assert(points.size() > 1 && "Not enough points for integration.");
@@ -161,7 +174,7 @@ void ProbabilityAnalysis::ComputeSil() noexcept {
 
 double CutSetProbabilityCalculator::Calculate(
     const std::vector<int>& cut_set,
-    const Pdag::IndexMap<double>& p_vars) noexcept {
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
   double p_sub_set = 1;  // 1 is for multiplication.
   for (int member : cut_set) {
     assert(member > 0 && "Complements in a cut set.");
@@ -170,30 +183,161 @@ double CutSetProbabilityCalculator::Calculate(
   return p_sub_set;
 }
 
+ZbddCalculator::ZbddCalculator(const Zbdd& cut_sets, int limit_order) noexcept
+    : cut_sets_(cut_sets) {
+  root_ = cut_sets.Flatten(&nodes_);
+  // The largest cut set orders; -1 for no cut sets.
+  std::vector<int> orders(nodes_.size());
+  auto retrieve = [&orders](int position) {
+    return position == Zbdd::kBasePosition
+               ? 0
+               : position == Zbdd::kEmptyPosition ? -1 : orders[position];
+  };
+  for (int i = 0; i < nodes_.size(); ++i) {
+    const Zbdd::FlatNode& node = nodes_[i];
+    int high = retrieve(node.high);
+    int var = node.module ? retrieve(node.index) : 1;
+    orders[i] = std::max(high < 0 || var < 0 ? -1 : high + var,
+                         retrieve(node.low));
+  }
+  enumerate_ = retrieve(root_) > limit_order;
+  if (enumerate_)
+    LOG(DEBUG4) << "Cut sets with modules exceed the limit order.";
+}
+
+double ZbddCalculator::CalculateMaxProbability(
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
+  std::vector<double> p_max(nodes_.size());
+  auto retrieve = [&p_max](int position) {
+    return position == Zbdd::kBasePosition
+               ? 1
+               : position == Zbdd::kEmptyPosition ? 0 : p_max[position];
+  };
+  for (int i = 0; i < nodes_.size(); ++i) {
+    const Zbdd::FlatNode& node = nodes_[i];
+    assert((node.module || node.index > 0) && "Complements in a cut set.");
+    double p_var = node.module ? retrieve(node.index) : p_vars[node.index];
+    p_max[i] = std::max(p_var * retrieve(node.high), retrieve(node.low));
+  }
+  return retrieve(root_);
+}
+
+std::vector<double> ZbddCalculator::CalculatePowerSums(
+    const Pdag::IndexMap<double>& p_vars, int num_powers) const noexcept {
+  std::vector<double> sums(nodes_.size() * num_powers);
+  std::vector<double> base(num_powers, 1);
+  std::vector<double> empty(num_powers, 0);
+  auto retrieve = [&](int position) {
+    return position == Zbdd::kBasePosition
+               ? base.data()
+               : position == Zbdd::kEmptyPosition
+                     ? empty.data()
+                     : sums.data() + position * num_powers;
+  };
+  for (int i = 0; i < nodes_.size(); ++i) {
+    const Zbdd::FlatNode& node = nodes_[i];
+    const double* high = retrieve(node.high);
+    const double* low = retrieve(node.low);
+    double* result = retrieve(i);
+    if (node.module) {  // The cut sets of the module and high are joined.
+      const double* module = retrieve(node.index);
+      for (int k = 0; k < num_powers; ++k)
+        result[k] = module[k] * high[k] + low[k];
+    } else {
+      assert(node.index > 0 && "Complements in a cut set.");
+      double p_var = p_vars[node.index];
+      double p_power = p_var;
+      for (int k = 0; k < num_powers; ++k) {
+        result[k] = p_power * high[k] + low[k];
+        p_power *= p_var;
+      }
+    }
+  }
+  const double* root = retrieve(root_);
+  return std::vector<double>(root, root + num_powers);
+}
+
 double RareEventCalculator::Calculate(
-    const Zbdd& cut_sets,
-    const Pdag::IndexMap<double>& p_vars) noexcept {
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
   double sum = 0;
-  for (const std::vector<int>& cut_set : cut_sets) {
-    sum += CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
+  if (ZbddCalculator::enumerate()) {
+    for (const std::vector<int>& cut_set : ZbddCalculator::cut_sets()) {
+      sum += CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
+    }
+  } else {
+    sum = ZbddCalculator::CalculatePowerSums(p_vars, 1).front();
   }
   return sum > 1 ? 1 : sum;
 }
 
 double McubCalculator::Calculate(
-    const Zbdd& cut_sets,
-    const Pdag::IndexMap<double>& p_vars) noexcept {
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
+  if (!ZbddCalculator::enumerate()) {
+    double p_max = ZbddCalculator::CalculateMaxProbability(p_vars);
+    if (p_max == 0)
+      return 0;
+    if (p_max == 1)
+      return 1;
+    const int kMaxPowers = 64;
+    const double kTolerance = 1e-16;
+    // The relative truncation error of the series with K terms
+    // is bounded by p_max^K / ((K + 1) * (1 - p_max)).
+    int num_powers = 1;
+    double bound = p_max / (2 * (1 - p_max));
+    for (; bound > kTolerance && num_powers < kMaxPowers; ++num_powers)
+      bound *= p_max * (num_powers + 1) / (num_powers + 2);
+    if (bound <= kTolerance) {
+      std::vector<double> sums =
+          ZbddCalculator::CalculatePowerSums(p_vars, num_powers);
+      double log_m = 0;  // The logarithm of the product of complements.
+      for (int k = 0; k < num_powers; ++k)
+        log_m -= sums[k] / (k + 1);
+      return -std::expm1(log_m);
+    }
+  }
   double m = 1;
-  for (const std::vector<int>& cut_set : cut_sets) {
+  for (const std::vector<int>& cut_set : ZbddCalculator::cut_sets()) {
     m *= 1 - CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
   }
   return 1 - m;
 }
 
 void ProbabilityAnalyzerBase::ExtractVariableProbabilities() {
-  p_vars_.reserve(graph_->basic_events().size());
-  for (const mef::BasicEvent* event : graph_->basic_events())
-    p_vars_.push_back(event->p());
+  std::vector<mef::Expression*> expressions;
+  expressions.reserve(graph_->basic_events().size());
+  for (const mef::BasicEvent* event : graph_->basic_events()) {
+    if (event->expression().IsTimeDependent())
+      time_dependent_vars_.push_back(Pdag::kVariableStartIndex +
+                                     expressions.size());
+    expressions.push_back(&event->expression());
+  }
+  // The shared subexpressions are evaluated once for all the events.
+  mef::ExpressionTape tape(expressions);
+  p_vars_.resize(tape.size());
+  tape.Evaluate(p_vars_.data());
+}
+
+constexpr int ProbabilityAnalyzerBase::kBatchSize;
+
+std::vector<double> ProbabilityAnalyzerBase::CalculateTotalProbabilities(
+    const std::vector<Pdag::IndexMap<double>>& p_vars_batch) noexcept {
+  std::vector<double> p_totals;
+  p_totals.reserve(p_vars_batch.size());
+  for (const Pdag::IndexMap<double>& p_vars : p_vars_batch)
+    p_totals.push_back(this->CalculateTotalProbability(p_vars));
+  return p_totals;
+}
+
+std::vector<double>
+ProbabilityAnalyzerBase::CalculateTimeDependentProbabilities(
+    const std::vector<std::vector<double>>& p_time_batch) noexcept {
+  std::vector<Pdag::IndexMap<double>> p_vars_batch(p_time_batch.size(),
+                                                   p_vars_);
+  for (int i = 0; i < p_time_batch.size(); ++i) {
+    for (int j = 0; j < time_dependent_vars_.size(); ++j)
+      p_vars_batch[i][time_dependent_vars_[j]] = p_time_batch[i][j];
+  }
+  return this->CalculateTotalProbabilities(p_vars_batch);
 }
 
 std::vector<std::pair<double, double>>
@@ -206,18 +350,135 @@ ProbabilityAnalyzerBase::CalculateProbabilityOverTime() noexcept {
   assert(Analysis::settings().mission_time() ==
          ProbabilityAnalysis::mission_time().value());
   double total_time = ProbabilityAnalysis::mission_time().value();
+  std::vector<double> time_points;
+  for (double time = 0; time < total_time; time += time_step)
+    time_points.push_back(time);
+  time_points.push_back(total_time);  // Not divisible by step cases.
+
+  if (!Analysis::settings().time_tolerance() || time_dependent_vars_.empty())
+    return CalculateProbabilities(time_points);
+
+  // The jumps in probabilities are bracketed with the points on both sides
+  // instead of smearing them over the refined steps.
+  std::vector<double> jumps;
+  for (int index : time_dependent_vars_) {
+    graph_->basic_events()[index]->expression().GatherDiscontinuities(
+        total_time, &jumps);
+  }
+  double gap = time_step * kMinTimeStep;
+  for (double time : jumps) {
+    if (time > 0 && time + gap < total_time) {
+      time_points.push_back(time);
+      time_points.push_back(time + gap);
+    }
+  }
+  std::sort(time_points.begin(), time_points.end());
+  time_points.erase(std::unique(time_points.begin(), time_points.end()),
+                    time_points.end());
+  p_time = CalculateProbabilities(time_points);
+  RefineTimeSteps(&p_time);
+  return p_time;
+}
 
-  auto update = [this, &p_time] (double time) {
-    mission_time().value(time);
-    auto it_p = p_vars_.begin();
-    for (const mef::BasicEvent* event : graph_->basic_events())
-      *it_p++ = event->p();
-    p_time.emplace_back(this->CalculateTotalProbability(p_vars_), time);
+void ProbabilityAnalyzerBase::RefineTimeSteps(
+    std::vector<std::pair<double, double>>* p_time) noexcept {
+  if (p_time->size() < 2)
+    return;
+  double tolerance = Analysis::settings().time_tolerance();
+  double min_step = Analysis::settings().time_step() * kMinTimeStep;
+  double range = p_time->back().second - p_time->front().second;
+  using Point = std::pair<double, double>;
+  // The SIL averages the failure frequency (PFH) as well.
+  bool sil = Analysis::settings().safety_integrity_levels();
+  auto pfh = [](const Point& point) {
+    return point.second ? point.first / point.second : 0;
   };
+  double integral = Integrate(*p_time);
+  double pfh_integral = 0;
+  for (int i = 1; i < p_time->size(); ++i) {
+    pfh_integral += (pfh((*p_time)[i]) + pfh((*p_time)[i - 1])) *
+                    ((*p_time)[i].second - (*p_time)[i - 1].second) / 2;
+  }
 
-  for (double time = 0; time < total_time; time += time_step)
-    update(time);
-  update(total_time);  // Handle cases when total_time is not divisible by step.
+  std::vector<std::pair<Point, Point>> intervals;  // To bisect.
+  for (int i = 1; i < p_time->size(); ++i) {
+    if ((*p_time)[i].second - (*p_time)[i - 1].second > 2 * min_step)
+      intervals.emplace_back((*p_time)[i - 1], (*p_time)[i]);
+  }
+  while (!intervals.empty()) {
+    std::vector<double> midpoints;
+    for (const std::pair<Point, Point>& interval : intervals)
+      midpoints.push_back((interval.first.second + interval.second.second) / 2);
+    Points p_midpoints = CalculateProbabilities(midpoints);
+
+    // The difference between the trapezoids of the interval and its halves
+    // is three times the error of the halves (Richardson extrapolation).
+    auto correction = [](double step, double left, double middle,
+                         double right) {
+      return step * (left + 2 * middle + right) / 4 -
+             step * (left + right) / 2;
+    };
+    std::vector<std::pair<double, double>> corrections;  // {PFD, PFH}
+    for (int i = 0; i < intervals.size(); ++i) {
+      const Point& left = intervals[i].first;
+      const Point& right = intervals[i].second;
+      const Point& middle = p_midpoints[i];
+      double step = right.second - left.second;
+      corrections.emplace_back(
+          correction(step, left.first, middle.first, right.first),
+          correction(step, pfh(left), pfh(middle), pfh(right)));
+      integral += corrections.back().first;
+      pfh_integral += corrections.back().second;
+    }
+    std::vector<std::pair<Point, Point>> next_intervals;
+    for (int i = 0; i < intervals.size(); ++i) {
+      double step = intervals[i].second.second - intervals[i].first.second;
+      double share = tolerance * step / range;  // The error budget.
+      if (step / 2 > 2 * min_step &&
+          (std::abs(corrections[i].first) / 3 > share * integral ||
+           (sil && std::abs(corrections[i].second) / 3 >
+                       share * pfh_integral))) {
+        next_intervals.emplace_back(intervals[i].first, p_midpoints[i]);
+        next_intervals.emplace_back(p_midpoints[i], intervals[i].second);
+      }
+    }
+    p_time->insert(p_time->end(), p_midpoints.begin(), p_midpoints.end());
+    intervals.swap(next_intervals);
+  }
+  std::sort(p_time->begin(), p_time->end(),
+            [](const Point& lhs, const Point& rhs) {
+              return lhs.second < rhs.second;
+            });
+  LOG(DEBUG3) << "Refined the time steps to " << p_time->size() << " points";
+}
+
+std::vector<std::pair<double, double>>
+ProbabilityAnalyzerBase::CalculateProbabilities(
+    const std::vector<double>& time_points) noexcept {
+  // The time points are calculated in batches shared by threads.
+  // Only the time-dependent probabilities are re-evaluated at each point.
+  std::vector<std::pair<double, double>> p_time(time_points.size());
+  std::vector<mef::Expression*> expressions;
+  for (int index : time_dependent_vars_)
+    expressions.push_back(&graph_->basic_events()[index]->expression());
+  const mef::ExpressionTape tape(expressions);
+  int num_batches = (time_points.size() + kBatchSize - 1) / kBatchSize;
+  ParallelFor(Analysis::settings().num_threads(), num_batches, [&](int batch) {
+    // The mission time changes are private to the batch.
+    mef::MissionTime::ThreadValue thread_time(&mission_time());
+    int first = batch * kBatchSize;
+    int batch_size = std::min<int>(kBatchSize, time_points.size() - first);
+    std::vector<std::vector<double>> p_time_batch(
+        batch_size, std::vector<double>(tape.size()));
+    for (int i = 0; i < batch_size; ++i) {
+      mission_time().value(time_points[first + i]);
+      tape.Evaluate(p_time_batch[i].data());
+    }
+    std::vector<double> p_totals =
+        this->CalculateTimeDependentProbabilities(p_time_batch);
+    for (int i = 0; i < batch_size; ++i)
+      p_time[first + i] = {p_totals[i], time_points[first + i]};
+  });
   return p_time;
 }
 
@@ -227,8 +488,7 @@ ProbabilityAnalyzer<Bdd>::ProbabilityAnalyzer(FaultTreeAnalyzer<Bdd>* fta,
       owner_(false) {
   LOG(DEBUG2) << "Re-using BDD from FaultTreeAnalyzer for ProbabilityAnalyzer";
   bdd_graph_ = fta->algorithm();
-  const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
-  current_mark_ = root->terminal() ? false : Ite::Ref(root).mark();
+  Compile();
 }
 
 ProbabilityAnalyzer<Bdd>::~ProbabilityAnalyzer() noexcept {
@@ -240,61 +500,198 @@ double ProbabilityAnalyzer<Bdd>::CalculateTotalProbability(
     const Pdag::IndexMap<double>& p_vars) noexcept {
   CLOCK(calc_time);  // BDD based calculation time.
   LOG(DEBUG4) << "Calculating probability with BDD...";
-  current_mark_ = !current_mark_;
-  double prob =
-      CalculateProbability(bdd_graph_->root().vertex, current_mark_, p_vars);
-  if (bdd_graph_->root().complement)
-    prob = 1 - prob;
+  double prob = 0;
+  Evaluate(flat_bdd_, p_vars.data(), 1, &prob);
   LOG(DEBUG4) << "Calculated probability " << prob << " in " << DUR(calc_time);
   return prob;
 }
 
-void ProbabilityAnalyzer<Bdd>::CreateBdd(
-    const FaultTreeAnalysis& fta) noexcept {
-  CLOCK(total_time);
+std::vector<double> ProbabilityAnalyzer<Bdd>::CalculateTotalProbabilities(
+    const std::vector<Pdag::IndexMap<double>>& p_vars_batch) noexcept {
+  CLOCK(calc_time);  // BDD based calculation time.
+  int num_lanes = p_vars_batch.size();
+  LOG(DEBUG4) << "Calculating " << num_lanes << " probabilities with BDD...";
+  std::vector<double> p_totals(num_lanes);
+  if (num_lanes == 1) {
+    Evaluate(flat_bdd_, p_vars_batch.front().data(), 1, p_totals.data());
+  } else if (num_lanes) {
+    // Transposition into lanes per variable.
+    int num_vars = p_vars_batch.front().size();
+    std::vector<double> p_lanes(num_vars * num_lanes);
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      const Pdag::IndexMap<double>& p_vars = p_vars_batch[lane];
+      assert(p_vars.size() == num_vars && "Inconsistent batch.");
+      for (int i = 0; i < num_vars; ++i)
+        p_lanes[i * num_lanes + lane] = p_vars.data()[i];
+    }
+    Evaluate(flat_bdd_, p_lanes.data(), num_lanes, p_totals.data());
+  }
+  LOG(DEBUG4) << "Calculated probabilities in " << DUR(calc_time);
+  return p_totals;
+}
 
-  CLOCK(ft_creation);
-  Pdag graph(fta.top_event(), Analysis::settings().ccf_analysis());
-  LOG(DEBUG2) << "PDAG is created in " << DUR(ft_creation);
+std::vector<double>
+ProbabilityAnalyzer<Bdd>::CalculateTimeDependentProbabilities(
+    const std::vector<std::vector<double>>& p_time_batch) noexcept {
+  int num_lanes = p_time_batch.size();
+  int num_time_vars = time_dependent_vars().size();
+  assert(time_bdd_.num_vars == num_time_vars + time_constants_.size() &&
+         "The BDD is not reduced for the time steps.");
+  std::vector<double> p_lanes(time_bdd_.num_vars * num_lanes);
+  for (int lane = 0; lane < num_lanes; ++lane) {
+    assert(p_time_batch[lane].size() == num_time_vars && "Inconsistent batch.");
+    for (int i = 0; i < num_time_vars; ++i)
+      p_lanes[i * num_lanes + lane] = p_time_batch[lane][i];
+  }
+  auto it = p_lanes.begin() + num_time_vars * num_lanes;
+  for (double constant : time_constants_)
+    it = std::fill_n(it, num_lanes, constant);
+  std::vector<double> p_totals(num_lanes);
+  Evaluate(time_bdd_, p_lanes.data(), num_lanes, p_totals.data());
+  return p_totals;
+}
 
-  CLOCK(prep_time);  // Overall preprocessing time.
-  LOG(DEBUG2) << "Preprocessing...";
-  CustomPreprocessor<Bdd>{&graph}();
-  LOG(DEBUG2) << "Finished preprocessing in " << DUR(prep_time);
+void ProbabilityAnalyzer<Bdd>::Evaluate(const FlatBdd& bdd,
+                                        const double* p_vars, int num_lanes,
+                                        double* p_total) noexcept {
+  std::vector<double> values((bdd.first_vertex() + bdd.size()) * num_lanes);
+  std::fill_n(values.begin(), num_lanes, 1);  // The terminal vertex.
+  std::copy_n(p_vars, bdd.num_vars * num_lanes, values.begin() + num_lanes);
+  EvaluateVertices(bdd, num_lanes, values.data());
+  const double* root = values.data() + bdd.root * num_lanes;
+  double root_offset = bdd.root_complement;
+  double root_sign = 1 - 2 * root_offset;
+  for (int lane = 0; lane < num_lanes; ++lane)
+    p_total[lane] = root_offset + root_sign * root[lane];
+}
 
+void ProbabilityAnalyzer<Bdd>::EvaluateVertices(const FlatBdd& bdd,
+                                                int num_lanes,
+                                                double* values) noexcept {
+  // The complements are applied as (offset + sign * value)
+  // to keep the lane loops free of branches.
+  double* result = values + bdd.first_vertex() * num_lanes;
+  for (int i = 0; i < bdd.size(); ++i, result += num_lanes) {
+    const double* p_var = values + bdd.var[i] * num_lanes;
+    const double* high = values + bdd.high[i] * num_lanes;
+    const double* low = values + bdd.low[i] * num_lanes;
+    double var_offset = bdd.var_complement[i];
+    double var_sign = 1 - 2 * var_offset;
+    double low_offset = bdd.complement_edge[i];
+    double low_sign = 1 - 2 * low_offset;
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      double p_lane = var_offset + var_sign * p_var[lane];
+      result[lane] = p_lane * high[lane] +
+                     (1 - p_lane) * (low_offset + low_sign * low[lane]);
+    }
+  }
+}
+
+void ProbabilityAnalyzer<Bdd>::CreateBdd(const Pdag& graph) noexcept {
   CLOCK(bdd_time);  // BDD based calculation time.
   LOG(DEBUG2) << "Creating BDD for Probability Analysis...";
   bdd_graph_ = new Bdd(&graph, Analysis::settings());
+  Compile();
   LOG(DEBUG2) << "BDD is created in " << DUR(bdd_time);
 
-  Analysis::AddAnalysisTime(DUR(total_time));
+  Analysis::AddAnalysisTime(DUR(bdd_time));
 }
 
-double ProbabilityAnalyzer<Bdd>::CalculateProbability(
-    const Bdd::VertexPtr& vertex,
-    bool mark,
-    const Pdag::IndexMap<double>& p_vars) noexcept {
-  if (vertex->terminal())
-    return 1;
-  Ite& ite = Ite::Ref(vertex);
-  if (ite.mark() == mark)
-    return ite.p();
-  ite.mark(mark);
-  double p_var = 0;
+void ProbabilityAnalyzer<Bdd>::Compile() noexcept {
+  flat_bdd_.num_vars = ProbabilityAnalyzerBase::graph()->basic_events().size();
+  std::unordered_map<int, int> slots;
+  flat_bdd_.root = Flatten(bdd_graph_->root().vertex, &slots);
+  flat_bdd_.root_complement = bdd_graph_->root().complement;
+  if (Analysis::settings().time_step())
+    Reduce();
+}
+
+void ProbabilityAnalyzer<Bdd>::Reduce() noexcept {
+  const FlatBdd& bdd = flat_bdd_;
+  int num_slots = bdd.first_vertex() + bdd.size();
+  std::vector<double> values(num_slots);
+  values.front() = 1;  // The terminal vertex.
+  std::copy(p_vars().begin(), p_vars().end(), values.begin() + 1);
+  EvaluateVertices(bdd, 1, values.data());
+
+  const std::vector<int>& time_vars = time_dependent_vars();
+  std::vector<std::uint8_t> dynamic(num_slots, false);
+  std::vector<int> reduced_slots(num_slots, 0);  // The terminal stays in 0.
+  for (int i = 0; i < time_vars.size(); ++i) {
+    int slot = 1 + time_vars[i] - Pdag::kVariableStartIndex;
+    dynamic[slot] = true;
+    reduced_slots[slot] = 1 + i;
+  }
+  for (int i = 0; i < bdd.size(); ++i) {
+    dynamic[bdd.first_vertex() + i] =
+        dynamic[bdd.var[i]] || dynamic[bdd.high[i]] || dynamic[bdd.low[i]];
+  }
+  // The static slots used by the dynamic vertices become constant variables.
+  time_constants_.clear();
+  auto add_constant = [this, &values, &dynamic, &reduced_slots,
+                       &time_vars](int slot) {
+    if (!slot || dynamic[slot] || reduced_slots[slot])
+      return;
+    time_constants_.push_back(values[slot]);
+    reduced_slots[slot] = time_vars.size() + time_constants_.size();
+  };
+  for (int i = 0; i < bdd.size(); ++i) {
+    if (!dynamic[bdd.first_vertex() + i])
+      continue;
+    add_constant(bdd.var[i]);
+    add_constant(bdd.high[i]);
+    add_constant(bdd.low[i]);
+  }
+  add_constant(bdd.root);
+
+  FlatBdd& reduced = time_bdd_;
+  reduced = {};
+  reduced.num_vars = time_vars.size() + time_constants_.size();
+  for (int i = 0; i < bdd.size(); ++i) {
+    int slot = bdd.first_vertex() + i;
+    if (!dynamic[slot])
+      continue;
+    reduced_slots[slot] = reduced.first_vertex() + reduced.size();
+    reduced.var.push_back(reduced_slots[bdd.var[i]]);
+    reduced.high.push_back(reduced_slots[bdd.high[i]]);
+    reduced.low.push_back(reduced_slots[bdd.low[i]]);
+    reduced.var_complement.push_back(bdd.var_complement[i]);
+    reduced.complement_edge.push_back(bdd.complement_edge[i]);
+  }
+  reduced.root = reduced_slots[bdd.root];
+  reduced.root_complement = bdd.root_complement;
+  LOG(DEBUG3) << "Reduced BDD for time steps to " << reduced.size() << " of "
+              << bdd.size() << " vertices";
+}
+
+int ProbabilityAnalyzer<Bdd>::Flatten(
+    Bdd::Handle vertex, std::unordered_map<int, int>* slots) noexcept {
+  if (Bdd::terminal(vertex))
+    return 0;
+  auto it = slots->find(vertex);
+  if (it != slots->end())
+    return it->second;
+  const Ite& ite = bdd_graph_->ite(vertex);
+  int var = 0;
+  bool var_complement = false;
   if (ite.module()) {
     const Bdd::Function& res = bdd_graph_->modules().find(ite.index())->second;
-    p_var = CalculateProbability(res.vertex, mark, p_vars);
-    if (res.complement)
-      p_var = 1 - p_var;
+    var = Flatten(res.vertex, slots);
+    var_complement = res.complement;
   } else {
-    p_var = p_vars[ite.index()];
+    var = 1 + ite.index() - Pdag::kVariableStartIndex;
   }
-  double high = CalculateProbability(ite.high(), mark, p_vars);
-  double low = CalculateProbability(ite.low(), mark, p_vars);
-  if (ite.complement_edge())
-    low = 1 - low;
-  ite.p(p_var * high + (1 - p_var) * low);
-  return ite.p();
+  int high = Flatten(ite.high(), slots);
+  int low = Flatten(ite.low(), slots);
+  FlatBdd& bdd = flat_bdd_;
+  int slot = bdd.first_vertex() + bdd.size();
+  bdd.var.push_back(var);
+  bdd.high.push_back(high);
+  bdd.low.push_back(low);
+  bdd.var_complement.push_back(var_complement);
+  bdd.complement_edge.push_back(ite.complement_edge());
+  slots->emplace(vertex, slot);
+  return slot;
 }
 
 }  // namespace core
@@ -21,6 +21,9 @@
 #ifndef SCRAM_SRC_PROBABILITY_ANALYSIS_H_
 #define SCRAM_SRC_PROBABILITY_ANALYSIS_H_
 
+#include <cstdint>
+
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -28,6 +31,7 @@
 #include "bdd.h"
 #include "fault_tree_analysis.h"
 #include "pdag.h"
+#include "zbdd.h"
 
 namespace scram {
 
@@ -70,6 +74,13 @@ class ProbabilityAnalysis : public Analysis {
   ProbabilityAnalysis(const FaultTreeAnalysis* fta,
                       mef::MissionTime* mission_time);
 
+  /// Probability analysis without qualitative analysis results.
+  ///
+  /// @param[in] settings  Analysis settings for all calculations.
+  /// @param[in] mission_time  The mission time expression of the model.
+  ProbabilityAnalysis(const Settings& settings,
+                      mef::MissionTime* mission_time);
+
   virtual ~ProbabilityAnalysis() = default;
 
   /// Performs quantitative analysis on the supplied fault tree.
@@ -142,19 +153,69 @@ class CutSetProbabilityCalculator {
   /// @pre Probability values are non-negative.
   /// @pre Indices of events directly map to vector indices.
   double Calculate(const std::vector<int>& cut_set,
-                   const Pdag::IndexMap<double>& p_vars) noexcept;
+                   const Pdag::IndexMap<double>& p_vars) const noexcept;
 };
 
-class Zbdd;  // The container of analysis products for computations.
+/// Quantitative calculator of values over the cut sets in a ZBDD.
+/// Instead of enumerating every cut set,
+/// the values are calculated with dynamic programming
+/// over the flattened set nodes of the ZBDD and its modules,
+/// i.e., in linear time on the size of the ZBDD.
+///
+/// @note The calculations do not modify the ZBDD
+///       and are safe to run concurrently.
+class ZbddCalculator : protected CutSetProbabilityCalculator {
+ public:
+  /// @param[in] cut_sets  A collection of sets of indices of basic events.
+  /// @param[in] limit_order  The limit on the order of cut sets.
+  ///
+  /// @pre The collection is not modified during the calculator lifetime.
+  ZbddCalculator(const Zbdd& cut_sets, int limit_order) noexcept;
+
+ protected:
+  /// @returns The collection of cut sets.
+  const Zbdd& cut_sets() const { return cut_sets_; }
+
+  /// @returns true if the cut sets must be enumerated one by one
+  ///          because the ZBDD with modules has cut sets
+  ///          beyond the limit order.
+  bool enumerate() const { return enumerate_; }
+
+  /// Calculates the largest probability of a cut set.
+  ///
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns The maximum cut set probability.
+  /// @returns 0 for the Empty set.
+  double CalculateMaxProbability(
+      const Pdag::IndexMap<double>& p_vars) const noexcept;
+
+  /// Calculates the sums of powers of cut set probabilities,
+  /// i.e., the sum of p^k over cut sets for k = 1, 2, ..., num_powers.
+  ///
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  /// @param[in] num_powers  The number of powers to calculate.
+  ///
+  /// @returns The sums of powers starting with the power of 1.
+  std::vector<double> CalculatePowerSums(const Pdag::IndexMap<double>& p_vars,
+                                         int num_powers) const noexcept;
+
+ private:
+  const Zbdd& cut_sets_;  ///< The source collection of cut sets.
+  std::vector<Zbdd::FlatNode> nodes_;  ///< The flattened set nodes.
+  int root_;  ///< The position of the root node.
+  bool enumerate_;  ///< The fallback to the cut set enumeration.
+};
 
 /// Quantitative calculator of probability values
 /// with the Rare-Event approximation.
-class RareEventCalculator : private CutSetProbabilityCalculator {
+class RareEventCalculator : private ZbddCalculator {
  public:
+  using ZbddCalculator::ZbddCalculator;
+
   /// Calculates probabilities
   /// using the Rare-Event approximation.
   ///
-  /// @param[in] cut_sets  A collection of sets of indices of basic events.
   /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
   ///
   /// @returns The total probability with the rare-event approximation.
@@ -163,23 +224,30 @@ class RareEventCalculator : private CutSetProbabilityCalculator {
   ///       the probability is adjusted to 1.
   ///       It is very unwise to use the rare-event approximation
   ///       with large probability values.
-  double Calculate(const Zbdd& cut_sets,
-                   const Pdag::IndexMap<double>& p_vars) noexcept;
+  double Calculate(const Pdag::IndexMap<double>& p_vars) const noexcept;
 };
 
 /// Quantitative calculator of probability values
 /// with the Min-Cut-Upper Bound approximation.
-class McubCalculator : private CutSetProbabilityCalculator {
+///
+/// The logarithm of the product of cut set complements
+/// is expanded into the series of power sums of cut set probabilities,
+/// ln(1 - MCUB) = -sum(S_k / k),
+/// which is truncated at the accuracy determined
+/// by the largest cut set probability.
+/// The cut sets are enumerated
+/// only if the series converges too slowly.
+class McubCalculator : private ZbddCalculator {
  public:
+  using ZbddCalculator::ZbddCalculator;
+
   /// Calculates probabilities
   /// using the minimal cut set upper bound (MCUB) approximation.
   ///
-  /// @param[in] cut_sets  A collection of sets of indices of basic events.
   /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
   ///
   /// @returns The total probability with the MCUB approximation.
-  double Calculate(const Zbdd& cut_sets,
-                   const Pdag::IndexMap<double>& p_vars) noexcept;
+  double Calculate(const Pdag::IndexMap<double>& p_vars) const noexcept;
 };
 
 /// Base class for Probability analyzers.
@@ -208,6 +276,43 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   /// @returns A mapping for probability values with indices.
   const Pdag::IndexMap<double>& p_vars() const { return p_vars_; }
 
+  /// @returns The indices of the variables
+  ///          with probabilities depending on the mission time.
+  const std::vector<int>& time_dependent_vars() const {
+    return time_dependent_vars_;
+  }
+
+  /// The preferred number of sets of probability values
+  /// to be calculated together in a batch.
+  static constexpr int kBatchSize = 16;
+
+  /// Calculates the total probabilities
+  /// for a batch of different sets of probability values.
+  ///
+  /// @param[in] p_vars_batch  Maps of probabilities of the graph variables.
+  ///
+  /// @returns The total probabilities in the order of the batch.
+  ///
+  /// @note The default implementation calculates the sets one by one.
+  virtual std::vector<double> CalculateTotalProbabilities(
+      const std::vector<Pdag::IndexMap<double>>& p_vars_batch) noexcept;
+
+  /// Calculates the total probabilities
+  /// for a batch of different values of the time-dependent variables.
+  /// The other variables keep their values from the p_vars().
+  ///
+  /// @param[in] p_time_batch  Probabilities of the time-dependent variables
+  ///                          in the order of time_dependent_vars().
+  ///
+  /// @returns The total probabilities in the order of the batch.
+  ///
+  /// @note The default implementation calculates
+  ///       with the complete sets of probability values.
+  /// @note The batches of time points are calculated concurrently,
+  ///       so implementations must be thread-safe.
+  virtual std::vector<double> CalculateTimeDependentProbabilities(
+      const std::vector<std::vector<double>>& p_time_batch) noexcept;
+
  protected:
   ~ProbabilityAnalyzerBase() override = default;
 
@@ -231,9 +336,26 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   std::vector<std::pair<double, double>>
   CalculateProbabilityOverTime() noexcept final;
 
+  /// Calculates the total probabilities at the given mission time points.
+  ///
+  /// @param[in] time_points  The mission time points.
+  ///
+  /// @returns The {probability, time} points in the order of the input.
+  std::vector<std::pair<double, double>> CalculateProbabilities(
+      const std::vector<double>& time_points) noexcept;
+
+  /// Refines the time steps adaptively by bisection
+  /// until the trapezoid error estimates of the intervals
+  /// are within the time tolerance of the average probability.
+  ///
+  /// @param[in,out] p_time  The {probability, time} points to refine.
+  void RefineTimeSteps(std::vector<std::pair<double, double>>* p_time) noexcept;
+
   /// Upon construction of the probability analysis,
   /// stores the variable probabilities in a continuous container
   /// for retrieval by their indices instead of pointers.
+  /// The variables with time-dependent probabilities are registered
+  /// to recalculate only their values at different mission times.
   ///
   /// @note This function may seem redundant,
   ///       for it's super-short and simple to do it inline in the constructor.
@@ -244,6 +366,7 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   const Pdag* graph_;  ///< PDAG from the fault tree analysis.
   const Zbdd& products_;  ///< A collection of products.
   Pdag::IndexMap<double> p_vars_;  ///< Variable probabilities.
+  std::vector<int> time_dependent_vars_;  ///< The time-dependent variables.
 };
 
 /// Fault-tree-analysis-aware probability analyzer.
@@ -253,11 +376,17 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
 template <class Calculator>
 class ProbabilityAnalyzer : public ProbabilityAnalyzerBase {
  public:
-  using ProbabilityAnalyzerBase::ProbabilityAnalyzerBase;
+  /// @copydoc ProbabilityAnalyzerBase::ProbabilityAnalyzerBase
+  template <class Algorithm>
+  ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm>* fta,
+                      mef::MissionTime* mission_time)
+      : ProbabilityAnalyzerBase(fta, mission_time),
+        calc_(ProbabilityAnalyzerBase::products(),
+              Analysis::settings().limit_order()) {}
 
   double CalculateTotalProbability(
       const Pdag::IndexMap<double>& p_vars) noexcept final {
-    return calc_.Calculate(ProbabilityAnalyzerBase::products(), p_vars);
+    return calc_.Calculate(p_vars);
   }
 
  private:
@@ -266,22 +395,59 @@ class ProbabilityAnalyzer : public ProbabilityAnalyzerBase {
 
 /// Specialization of probability analyzer with Binary Decision Diagrams.
 /// The quantitative analysis is done with BDD.
+///
+/// The BDD is compiled upon construction
+/// into arrays of vertices in the topological order,
+/// so that the calculations do not modify the BDD
+/// and can run concurrently.
 template <>
 class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
  public:
+  /// BDD with modules compiled for evaluation
+  /// into the structure of arrays in the topological order (children first).
+  /// The vertices refer to slots of the evaluation values:
+  /// the terminal vertex (slot 0),
+  /// the variable probabilities in the order of indices,
+  /// and the vertex values.
+  /// The module vertices refer to the slots of the module root vertices,
+  /// so the evaluation is a single loop
+  /// without recursion, hash lookups, or branches on vertex kinds.
+  struct FlatBdd {
+    /// @returns The number of vertices.
+    int size() const { return var.size(); }
+
+    /// @returns The slot of the first vertex.
+    int first_vertex() const { return 1 + num_vars; }
+
+    int num_vars;  ///< The number of variables.
+    int root;  ///< The slot of the root vertex.
+    bool root_complement;  ///< The complement of the root function.
+    std::vector<int> var;  ///< The slots of the variables or module roots.
+    std::vector<int> high;  ///< The slots of the high vertices.
+    std::vector<int> low;  ///< The slots of the low vertices.
+    /// The complements of the module functions (false for variables).
+    std::vector<std::uint8_t> var_complement;
+    std::vector<std::uint8_t> complement_edge;  ///< The complements of lows.
+  };
+
   /// Constructs probability analyzer from a fault tree analyzer
-  /// with the same algorithm.
+  /// with a different algorithm.
+  /// The BDD is built from the already preprocessed PDAG of the analyzer
+  /// instead of repeating the preprocessing.
   ///
   /// @tparam Algorithm  Fault tree analysis algorithm.
   ///
   /// @copydetails ProbabilityAnalysis::ProbabilityAnalysis
+  ///
+  /// @pre The algorithm preprocessing leaves the PDAG normalized
+  ///      and preserves the relative order of variables and modules
+  ///      (true for ZBDD and MOCUS).
   template <class Algorithm>
   ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm>* fta,
                       mef::MissionTime* mission_time)
       : ProbabilityAnalyzerBase(fta, mission_time),
-        current_mark_(false),
         owner_(true) {
-    CreateBdd(*fta);
+    CreateBdd(*fta->graph());
   }
 
   /// Reuses BDD structures from Fault tree analyzer.
@@ -302,35 +468,90 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   /// @returns Binary decision diagram used for calculations.
   Bdd* bdd_graph() { return bdd_graph_; }
 
+  /// @returns The compiled BDD with the root as the last vertex.
+  ///          The graph is empty if the root is the terminal vertex.
+  const FlatBdd& flat_bdd() const { return flat_bdd_; }
+
+  /// @copydoc ProbabilityAnalyzerBase::CalculateTotalProbability
+  ///
+  /// @note This function is safe to call concurrently.
   double CalculateTotalProbability(
       const Pdag::IndexMap<double>& p_vars) noexcept final;
 
+  /// @copydoc ProbabilityAnalyzerBase::CalculateTotalProbabilities
+  ///
+  /// @note The batch is calculated in a single pass over the BDD.
+  /// @note This function is safe to call concurrently.
+  std::vector<double> CalculateTotalProbabilities(
+      const std::vector<Pdag::IndexMap<double>>& p_vars_batch) noexcept final;
+
+  /// @copydoc ProbabilityAnalyzerBase::CalculateTimeDependentProbabilities
+  ///
+  /// @note Only the vertices depending on the time-dependent variables
+  ///       are recalculated.
+  /// @note This function is safe to call concurrently.
+  ///
+  /// @pre The analysis settings have the time step.
+  std::vector<double> CalculateTimeDependentProbabilities(
+      const std::vector<std::vector<double>>& p_time_batch) noexcept final;
+
  private:
   /// Creates a new BDD for use by the analyzer.
   ///
-  /// @param[in] fta  The fault tree analysis providing the root gate.
+  /// @param[in] graph  The preprocessed PDAG of the fault tree analysis.
   ///
   /// @pre The function is called in the constructor only once.
-  void CreateBdd(const FaultTreeAnalysis& fta) noexcept;
+  void CreateBdd(const Pdag& graph) noexcept;
+
+  /// Compiles the BDD graph into the flat evaluation layout
+  /// and its reduction for the time steps if requested.
+  ///
+  /// @pre The BDD is frozen.
+  void Compile() noexcept;
 
-  /// Calculates exact probability
-  /// of a function graph represented by its root BDD vertex.
+  /// Reduces the compiled BDD
+  /// to the vertices depending on the time-dependent variables.
+  /// The other vertices are evaluated once
+  /// and enter the reduced BDD as constant variables
+  /// after the time-dependent variables.
+  void Reduce() noexcept;
+
+  /// Flattens the function graph and its modules
+  /// into the topologically sorted vertices (children first).
   ///
   /// @param[in] vertex  The root vertex of a function graph.
-  /// @param[in] mark  A flag to mark traversed vertices.
-  /// @param[in] p_vars  The probabilities of the variables
-  ///                    mapped by their indices.
+  /// @param[in,out] slots  The slots of flattened vertices by ids.
+  ///
+  /// @returns The slot of the flattened root vertex.
+  int Flatten(Bdd::Handle vertex, std::unordered_map<int, int>* slots) noexcept;
+
+  /// Evaluates the flattened BDD for lanes of variable probabilities.
   ///
-  /// @returns Probability value.
+  /// @param[in] bdd  The compiled BDD to evaluate.
+  /// @param[in] p_vars  The probabilities of variables in lanes
+  ///                    starting with the first variable index.
+  /// @param[in] num_lanes  The number of lanes.
+  /// @param[out] p_total  The total probabilities for each lane.
+  static void Evaluate(const FlatBdd& bdd, const double* p_vars,
+                       int num_lanes, double* p_total) noexcept;
+
+  /// Evaluates the vertices of the flattened BDD in lanes.
+  /// The lanes of a slot are stored contiguously
+  /// (structure of arrays)
+  /// for the inner loops over the lanes to get vectorized.
   ///
-  /// @warning If a vertex is already marked with the input mark,
-  ///          it will not be traversed and updated with a probability value.
-  double CalculateProbability(const Bdd::VertexPtr& vertex, bool mark,
-                              const Pdag::IndexMap<double>& p_vars) noexcept;
+  /// @param[in] bdd  The compiled BDD to evaluate.
+  /// @param[in] num_lanes  The number of lanes.
+  /// @param[in,out] values  The lanes of the slot values
+  ///                        with the terminal and variable slots given.
+  static void EvaluateVertices(const FlatBdd& bdd, int num_lanes,
+                               double* values) noexcept;
 
   Bdd* bdd_graph_;  ///< The main BDD graph for analysis.
-  bool current_mark_;  ///< To keep track of BDD current mark.
   bool owner_;  ///< Indication that pointers are handles.
+  FlatBdd flat_bdd_;  ///< The compiled BDD with the root as the last vertex.
+  FlatBdd time_bdd_;  ///< The BDD reduced to the time-dependent vertices.
+  std::vector<double> time_constants_;  ///< The constant reduced variables.
 };
 
 }  // namespace core
@@ -20,8 +20,64 @@
 
 #include "random.h"
 
+#include <algorithm>
+
+#include <boost/math/constants/constants.hpp>
+
 namespace scram {
 
-std::mt19937 Random::rng_;
+void Philox::Generate() noexcept {
+  const std::uint64_t kMultiplier[] = {0xD2511F53, 0xCD9E8D57};
+  const std::uint32_t kWeyl[] = {0x9E3779B9, 0xBB67AE85};
+  std::array<std::uint32_t, 4> block = counter_;
+  std::array<std::uint32_t, 2> key = key_;
+  for (int round = 0; round < 10; ++round) {
+    std::uint64_t product_0 = kMultiplier[0] * block[0];
+    std::uint64_t product_1 = kMultiplier[1] * block[2];
+    block = {static_cast<std::uint32_t>(product_1 >> 32) ^ block[1] ^ key[0],
+             static_cast<std::uint32_t>(product_1),
+             static_cast<std::uint32_t>(product_0 >> 32) ^ block[3] ^ key[1],
+             static_cast<std::uint32_t>(product_0)};
+    key[0] += kWeyl[0];
+    key[1] += kWeyl[1];
+  }
+  output_ = block;
+  position_ = 0;
+  if (++counter_[0] == 0)
+    ++counter_[1];
+}
+
+void Random::NormalGenerator(double mean, double sigma, int num_values,
+                             double* values) noexcept {
+  assert(sigma >= 0);
+  const double kTwoPi = 2 * boost::math::constants::pi<double>();
+  const int kNumPairs = 16;  // The pairs transformed together.
+  double radius[kNumPairs];
+  double angle[kNumPairs];
+  for (int first = 0; first < num_values; first += 2 * kNumPairs) {
+    int num_pairs = std::min(kNumPairs, (num_values - first + 1) / 2);
+    for (int i = 0; i < num_pairs; ++i) {
+      radius[i] = 1 - UnitGenerator();  // Excludes 0 for the logarithm.
+      angle[i] = UnitGenerator();
+    }
+    for (int i = 0; i < num_pairs; ++i) {
+      radius[i] = sigma * std::sqrt(-2 * std::log(radius[i]));
+      angle[i] *= kTwoPi;
+    }
+    double* pair = values + first;
+    int num_cosines = std::min(num_pairs, (num_values - first) / 2);
+    for (int i = 0; i < num_cosines; ++i) {
+      pair[2 * i] = mean + radius[i] * std::cos(angle[i]);
+      pair[2 * i + 1] = mean + radius[i] * std::sin(angle[i]);
+    }
+    if (num_cosines < num_pairs)  // The odd last value.
+      pair[2 * num_cosines] =
+          mean + radius[num_cosines] * std::cos(angle[num_cosines]);
+  }
+}
+
+std::uint32_t Random::seed_ = 0;
+thread_local int Random::target_ = 0;
+thread_local Philox Random::rng_;
 
 }  // namespace scram
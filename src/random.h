@@ -23,7 +23,10 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 
+#include <array>
+#include <limits>
 #include <random>
 
 #include <boost/random/beta_distribution.hpp>
@@ -31,6 +34,56 @@
 
 namespace scram {
 
+/// Counter-based random number engine Philox4x32-10
+/// (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11).
+/// The engine generates numbers by scrambling consecutive counters with a key,
+/// so that any stream of numbers identified by the key and stream number
+/// can be positioned without generating the preceding numbers.
+class Philox {
+ public:
+  using result_type = std::uint32_t;  ///< The type of generated numbers.
+
+  /// @returns The smallest generated value.
+  static constexpr result_type min() { return 0; }
+
+  /// @returns The largest generated value.
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /// Positions the engine at the start of a stream.
+  ///
+  /// @param[in] key  The key of the family of streams.
+  /// @param[in] stream  The stream number within the family.
+  void seek(std::uint64_t key, std::uint64_t stream) noexcept {
+    key_ = {static_cast<std::uint32_t>(key),
+            static_cast<std::uint32_t>(key >> 32)};
+    counter_ = {0, 0, static_cast<std::uint32_t>(stream),
+                static_cast<std::uint32_t>(stream >> 32)};
+    position_ = kBlockSize;
+  }
+
+  /// @returns The next number of the stream.
+  result_type operator()() noexcept {
+    if (position_ == kBlockSize)
+      Generate();
+    return output_[position_++];
+  }
+
+ private:
+  static const int kBlockSize = 4;  ///< The number of generated values.
+
+  /// Generates the next block of numbers from the current counter
+  /// and advances the counter.
+  void Generate() noexcept;
+
+  std::array<std::uint32_t, 2> key_{};  ///< The key of the streams.
+  /// The block number (lower words) and the stream number (upper words).
+  std::array<std::uint32_t, 4> counter_{};
+  std::array<std::uint32_t, kBlockSize> output_{};  ///< The generated block.
+  int position_ = kBlockSize;  ///< The position of the next number.
+};
+
 /// This class contains generators for various random distributions.
 /// The values passed to the member functions are asserted
 /// to be in the correct form.
@@ -40,13 +93,45 @@ namespace scram {
 ///
 /// This facility wraps the engine and distributions.
 /// It provides convenience and reproducibility for the whole analysis.
+///
+/// Each thread owns its random number generator
+/// positioned at independent streams
+/// identified by the seed, analysis target, and Monte Carlo trial.
+/// Any stream can be regenerated on its own,
+/// so the results do not depend on the order of the trials or threads.
 class Random {
  public:
-  /// Sets the seed of the underlying random number generator.
+  /// Sets the seed of the random number generators
+  /// and positions the generator of the current thread
+  /// at the start of the first stream.
   ///
   /// @param[in] seed  The seed for RNGs.
+  ///
+  /// @pre No other threads are generating random numbers.
   static void seed(int seed) noexcept {
-    Random::rng_.seed(static_cast<unsigned>(seed));
+    Random::seed_ = static_cast<std::uint32_t>(seed);
+    Random::stream(0, 0);
+  }
+
+  /// Positions the generator of the current thread
+  /// at the start of the stream for a trial of an analysis target.
+  ///
+  /// @param[in] target  The identifier of the analysis target.
+  /// @param[in] trial  The index of the Monte Carlo trial.
+  static void stream(int target, int trial) noexcept {
+    Random::target_ = target;
+    rng_.seek((static_cast<std::uint64_t>(seed_) << 32) |
+                  static_cast<std::uint32_t>(target),
+              static_cast<std::uint32_t>(trial));
+  }
+
+  /// @returns The analysis target of the current thread's stream.
+  static int target() noexcept { return Random::target_; }
+
+  /// @returns A word of independent, uniformly distributed random bits.
+  static std::uint64_t BitGenerator() noexcept {
+    std::uint64_t high = rng_();
+    return high << 32 | rng_();
   }
 
   /// RNG from a uniform distribution.
@@ -246,8 +331,76 @@ class Random {
     return std::exp(TriangularGenerator(lower, mode, upper));
   }
 
+  /// @name Batch generators
+  /// The batch generators fill arrays with independent samples
+  /// of a distribution with the same parameters.
+  /// The distribution setup is shared by the whole batch,
+  /// and the transformations of uniform numbers are done
+  /// in separate loops over the arrays.
+  ///
+  /// The parameters are the same as for the single value generators.
+  /// @param[in] num_values  The number of values to generate.
+  /// @param[out] values  The destination array for the sampled values.
+  /// @{
+  static void UniformRealGenerator(double lower, double upper, int num_values,
+                                   double* values) noexcept {
+    assert(lower < upper);
+    for (int i = 0; i < num_values; ++i)
+      values[i] = UnitGenerator();
+    for (int i = 0; i < num_values; ++i)
+      values[i] = lower + (upper - lower) * values[i];
+  }
+
+  /// @note The values are generated in pairs with the Box-Muller transform.
+  static void NormalGenerator(double mean, double sigma, int num_values,
+                              double* values) noexcept;
+
+  static void LognormalGenerator(double m, double s, int num_values,
+                                 double* values) noexcept {
+    assert(s >= 0);
+    NormalGenerator(m, s, num_values, values);
+    for (int i = 0; i < num_values; ++i)
+      values[i] = std::exp(values[i]);
+  }
+
+  static void GammaGenerator(double k, double theta, int num_values,
+                             double* values) noexcept {
+    assert(k > 0);
+    assert(theta > 0);
+    std::gamma_distribution<> dist(k);
+    for (int i = 0; i < num_values; ++i)
+      values[i] = dist(rng_) * theta;
+  }
+
+  static void BetaGenerator(double alpha, double beta, int num_values,
+                            double* values) noexcept {
+    assert(alpha > 0);
+    assert(beta > 0);
+    boost::random::beta_distribution<> dist(alpha, beta);
+    for (int i = 0; i < num_values; ++i)
+      values[i] = dist(rng_);
+  }
+
+  template <class IteratorB, class IteratorW>
+  static void HistogramGenerator(IteratorB first_b, IteratorB last_b,
+                                 IteratorW first_w, int num_values,
+                                 double* values) noexcept {
+    std::piecewise_constant_distribution<> dist(first_b, last_b, first_w);
+    for (int i = 0; i < num_values; ++i)
+      values[i] = dist(rng_);
+  }
+  /// @}
+
  private:
-  static std::mt19937 rng_;  ///< The random number generator.
+  /// @returns A uniformly distributed number in [0, 1)
+  ///          with the full 53-bit precision of doubles.
+  static double UnitGenerator() noexcept {
+    return (BitGenerator() >> 11) * (1.0 / (std::uint64_t(1) << 53));
+  }
+
+  static std::uint32_t seed_;  ///< The seed shared by all threads.
+  static thread_local int target_;  ///< The analysis target of the stream.
+  static thread_local Philox rng_;  ///< The random number generator.
 };
 
 }  // namespace scram
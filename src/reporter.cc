@@ -85,9 +85,14 @@ void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
   }
 
   for (const core::RiskAnalysis::Result& result : risk_an.results()) {
-    if (result.fault_tree_analysis)
+    if (result.fault_tree_analysis) {
       ReportResults(result.id, *result.fault_tree_analysis,
                     result.probability_analysis.get(), &results);
+    } else if (const auto* simulation =
+                   dynamic_cast<const core::MonteCarloAnalyzer*>(
+                       result.probability_analysis.get())) {
+      ReportResults(result.id, *simulation, &results);
+    }
 
     if (result.probability_analysis)
       ReportResults(result.id, *result.probability_analysis, &results);
@@ -117,7 +122,7 @@ template <>
 void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
     const core::Settings& settings,
     xml::StreamElement* information) {
-  {
+  if (!settings.monte_carlo()) {  // The simulation generates no products.
     xml::StreamElement quant = information->AddChild("calculated-quantity");
     if (settings.prime_implicants()) {
       quant.SetAttribute("name", "Prime Implicants");
@@ -135,9 +140,12 @@ void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
       case core::Algorithm::kMocus:
         methods.SetAttribute("name", "MOCUS");
     }
-    methods.AddChild("limits")
-        .AddChild("product-order")
-        .AddText(settings.limit_order());
+    xml::StreamElement limits = methods.AddChild("limits");
+    limits.AddChild("product-order").AddText(settings.limit_order());
+    if (settings.probability_analysis() && settings.cut_off())
+      limits.AddChild("cut-off").AddText(settings.cut_off());
+    if (settings.probability_analysis() && settings.top_products())
+      limits.AddChild("top-products").AddText(settings.top_products());
   }
   if (settings.ccf_analysis()) {
     information->AddChild("calculated-quantity")
@@ -156,26 +164,40 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
   quant.SetAttribute("name", "Probability Analysis")
       .SetAttribute("definition",
                     "Quantitative analysis of"
-                    " failure probability or unavailability")
-      .SetAttribute("approximation",
-                    core::kApproximationToString[static_cast<int>(
-                        settings.approximation())]);
+                    " failure probability or unavailability");
+  if (!settings.monte_carlo()) {
+    quant.SetAttribute("approximation",
+                       core::kApproximationToString[static_cast<int>(
+                           settings.approximation())]);
+  }
 
   xml::StreamElement methods = quant.AddChild("calculation-method");
-  switch (settings.approximation()) {
-    case core::Approximation::kNone:
-      methods.SetAttribute("name", "Binary Decision Diagram");
-      break;
-    case core::Approximation::kRareEvent:
-      methods.SetAttribute("name", "Rare-Event Approximation");
-      break;
-    case core::Approximation::kMcub:
-      methods.SetAttribute("name", "MCUB Approximation");
+  if (settings.monte_carlo()) {
+    methods.SetAttribute("name", "Monte Carlo Simulation");
+  } else {
+    switch (settings.approximation()) {
+      case core::Approximation::kNone:
+        methods.SetAttribute("name", "Binary Decision Diagram");
+        break;
+      case core::Approximation::kRareEvent:
+        methods.SetAttribute("name", "Rare-Event Approximation");
+        break;
+      case core::Approximation::kMcub:
+        methods.SetAttribute("name", "MCUB Approximation");
+    }
   }
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("mission-time").AddText(settings.mission_time());
-  if (settings.time_step())
+  if (settings.time_step()) {
     limits.AddChild("time-step").AddText(settings.time_step());
+    if (settings.time_tolerance() && !settings.monte_carlo())
+      limits.AddChild("time-tolerance").AddText(settings.time_tolerance());
+  }
+  if (settings.monte_carlo()) {
+    limits.AddChild("number-of-trials").AddText(settings.monte_carlo());
+    if (settings.seed() >= 0)
+      limits.AddChild("seed").AddText(settings.seed());
+  }
 }
 
 /// Describes the importance analysis and techniques.
@@ -385,6 +407,9 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   sum_of_products
       .SetAttribute("basic-events", fta.products().product_events().size())
       .SetAttribute("products", fta.products().size());
+  if (fta.products().total_size() != fta.products().size())
+    sum_of_products.SetAttribute("total-products",
+                                 fta.products().total_size());
 
   if (prob_analysis)
     sum_of_products.SetAttribute("probability", prob_analysis->p_total());
@@ -393,16 +418,14 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
     sum_of_products.SetAttribute(
         "distribution",
         boost::join(fta.products().Distribution() |
-                        boost::adaptors::transformed(
-                            [](int number) { return std::to_string(number); }),
+                        boost::adaptors::transformed([](std::int64_t number) {
+                          return std::to_string(number);
+                        }),
                     " "));
   }
 
-  double sum = 0;  // Sum of probabilities for contribution calculations.
-  if (prob_analysis) {
-    for (const core::Product& product_set : fta.products())
-      sum += product_set.p();
-  }
+  // Sum of probabilities for contribution calculations.
+  double sum = prob_analysis ? fta.products().p_sum() : 0;
   for (const core::Product& product_set : fta.products()) {
     xml::StreamElement product = sum_of_products.AddChild("product");
     product.SetAttribute("order", product_set.order());
@@ -418,6 +441,24 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   }
 }
 
+void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
+                             const core::MonteCarloAnalyzer& simulation,
+                             xml::StreamElement* results) {
+  xml::StreamElement estimate = results->AddChild("simulation");
+  scram::PutId(id, &estimate);
+  if (!simulation.warnings().empty())
+    estimate.SetAttribute("warning", simulation.warnings());
+
+  estimate.SetAttribute("trials", simulation.num_trials())
+      .SetAttribute("probability", simulation.p_total());
+  estimate.AddChild("standard-error")
+      .SetAttribute("value", simulation.standard_error());
+  estimate.AddChild("confidence-range")
+      .SetAttribute("percentage", "95")
+      .SetAttribute("lower-bound", simulation.confidence_interval().first)
+      .SetAttribute("upper-bound", simulation.confidence_interval().second);
+}
+
 void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
                              const core::ProbabilityAnalysis& prob_analysis,
                              xml::StreamElement* results) {
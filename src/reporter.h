@@ -29,6 +29,7 @@
 #include "fault_tree_analysis.h"
 #include "importance_analysis.h"
 #include "model.h"
+#include "monte_carlo.h"
 #include "probability_analysis.h"
 #include "risk_analysis.h"
 #include "settings.h"
@@ -148,6 +149,15 @@ class Reporter {
                      const core::ProbabilityAnalysis& prob_analysis,
                      xml::StreamElement* results);
 
+  /// Reports the estimate of the probability simulation.
+  ///
+  /// @param[in] id  The analysis id.
+  /// @param[in] simulation  Monte Carlo simulation with results.
+  /// @param[in,out] results  XML element to for all results.
+  void ReportResults(const core::RiskAnalysis::Result::Id& id,
+                     const core::MonteCarloAnalyzer& simulation,
+                     xml::StreamElement* results);
+
   /// Reports results of importance analysis.
   ///
   /// @param[in] id  The analysis id.
@@ -20,10 +20,17 @@
 
 #include "risk_analysis.h"
 
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <thread>
+
 #include "bdd.h"
 #include "fault_tree.h"
 #include "logger.h"
 #include "mocus.h"
+#include "monte_carlo.h"
+#include "parallel.h"
 #include "random.h"
 #include "zbdd.h"
 
@@ -36,7 +43,7 @@ RiskAnalysis::RiskAnalysis(mef::Model* model, const Settings& settings)
 void RiskAnalysis::Analyze() noexcept {
   assert(results_.empty() && "Rerunning the analysis.");
   // Set the seed for the pseudo-random number generator if given explicitly.
-  // Otherwise it defaults to the implementation dependent value.
+  // Otherwise it defaults to the implementation default value of 0.
   if (Analysis::settings().seed() >= 0)
     Random::seed(Analysis::settings().seed());
 
@@ -85,6 +92,9 @@ void RiskAnalysis::RunAnalysis(boost::optional<Context> context) noexcept {
     }
   }
 
+  int first_result = results_.size();
+  std::vector<std::pair<const mef::Gate*, int>> targets;  // With results.
+  std::vector<std::unique_ptr<EventTreeAnalysis>> event_tree_analyses;
   for (const mef::InitiatingEventPtr& initiating_event :
        model_->initiating_events()) {
     if (initiating_event->event_tree()) {
@@ -94,39 +104,85 @@ void RiskAnalysis::RunAnalysis(boost::optional<Context> context) noexcept {
                                                      model_->context());
       eta->Analyze();
       for (EventTreeAnalysis::Result& result : eta->sequences()) {
-        const mef::Sequence& sequence = result.sequence;
-        LOG(INFO) << "Running analysis for sequence: " << sequence.name();
         results_.push_back(
             {{std::pair<const mef::InitiatingEvent&, const mef::Sequence&>{
-                  *initiating_event, sequence},
+                  *initiating_event, result.sequence},
               context}});
-        RunAnalysis(*result.gate, &results_.back());
-        if (result.is_expression_only) {
-          results_.back().fault_tree_analysis = nullptr;
-          results_.back().importance_analysis = nullptr;
-        }
-        if (Analysis::settings().probability_analysis())
-          result.p_sequence = results_.back().probability_analysis->p_total();
-        LOG(INFO) << "Finished analysis for sequence: " << sequence.name();
+        targets.emplace_back(result.gate.get(), results_.size() - 1);
       }
-      event_tree_results_.push_back(
-          {*initiating_event, context, std::move(eta)});
-      LOG(INFO) << "Finished event tree analysis: " << initiating_event->name();
+      event_tree_analyses.push_back(std::move(eta));
     }
   }
 
   for (const mef::FaultTreePtr& ft : model_->fault_trees()) {
     for (const mef::Gate* target : ft->top_events()) {
-      LOG(INFO) << "Running analysis for gate: " << target->id();
       results_.push_back({{target, context}});
-      RunAnalysis(*target, &results_.back());
-      LOG(INFO) << "Finished analysis for gate: " << target->id();
+      targets.emplace_back(target, results_.size() - 1);
+    }
+  }
+
+  RunAnalysis(targets);
+
+  auto it_result = std::next(results_.begin(), first_result);
+  for (std::unique_ptr<EventTreeAnalysis>& eta : event_tree_analyses) {
+    for (EventTreeAnalysis::Result& result : eta->sequences()) {
+      if (result.is_expression_only) {
+        it_result->fault_tree_analysis = nullptr;
+        it_result->importance_analysis = nullptr;
+      }
+      if (Analysis::settings().probability_analysis())
+        result.p_sequence = it_result->probability_analysis->p_total();
+      ++it_result;
     }
+    const mef::InitiatingEvent& initiating_event = eta->initiating_event();
+    event_tree_results_.push_back({initiating_event, context, std::move(eta)});
+    LOG(INFO) << "Finished event tree analysis: " << initiating_event.name();
   }
 }
 
+void RiskAnalysis::RunAnalysis(
+    const std::vector<std::pair<const mef::Gate*, int>>& targets) noexcept {
+  int num_threads = Analysis::settings().num_threads();
+  int num_workers = std::min<int>(num_threads, targets.size());
+  if (num_workers > 1) {
+    LOG(DEBUG1) << "Analyzing " << targets.size() << " targets in "
+                << num_workers << " threads...";
+    // The remaining threads are shared by the analyses of each target.
+    Analysis::settings().num_threads(num_threads / num_workers);
+  }
+  std::thread::id caller = std::this_thread::get_id();
+  ParallelFor(num_workers, targets.size(), [&](int i) {
+    // Other threads must not share the mutable state of the model.
+    boost::optional<mef::Expression::ThreadSampling> thread_sampling;
+    boost::optional<mef::MissionTime::ThreadValue> mission_time;
+    if (std::this_thread::get_id() != caller) {
+      thread_sampling.emplace();
+      mission_time.emplace(&model_->mission_time());
+    }
+    Result& result = results_[targets[i].second];
+    const auto* sequence =
+        boost::get<std::pair<const mef::InitiatingEvent&,
+                             const mef::Sequence&>>(&result.id.target);
+    std::string name = sequence ? "sequence: " + sequence->second.name()
+                                : "gate: " + targets[i].first->id();
+    LOG(INFO) << "Running analysis for " << name;
+    RunAnalysis(*targets[i].first, &result);
+    LOG(INFO) << "Finished analysis for " << name;
+  });
+  Analysis::settings().num_threads(num_threads);
+}
+
 void RiskAnalysis::RunAnalysis(const mef::Gate& target,
                                Result* result) noexcept {
+  // Random numbers of each target come from their own streams.
+  Random::stream(result - results_.data(), 0);
+  if (Analysis::settings().monte_carlo()) {  // No qualitative analysis.
+    auto mca = std::make_unique<MonteCarloAnalyzer>(
+        target, Analysis::settings(), &model_->mission_time());
+    mca->Analyze();
+    result->probability_analysis = std::move(mca);
+    return;
+  }
   switch (Analysis::settings().algorithm()) {
     case Algorithm::kBdd:
       return RunAnalysis<Bdd>(target, result);
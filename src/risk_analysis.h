@@ -123,6 +123,16 @@ class RiskAnalysis : public Analysis {
   /// @post The model is restored to the original state.
   void RunAnalysis(boost::optional<Context> context = {}) noexcept;
 
+  /// Runs the analyses of independent targets
+  /// in parallel threads if requested in the settings.
+  /// The threads get private sampling and mission time states of the model.
+  ///
+  /// @param[in] targets  The analysis targets with positions of their results.
+  ///
+  /// @pre The result containers are allocated for the targets.
+  void RunAnalysis(
+      const std::vector<std::pair<const mef::Gate*, int>>& targets) noexcept;
+
   /// Runs all possible analysis on a given target.
   /// Analysis types are deduced from the settings.
   ///
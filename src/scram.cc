@@ -67,6 +67,11 @@ po::options_description ConstructOptions() {
       ("zbdd", "Perform qualitative analysis with ZBDD")
       ("mocus", "Perform qualitative analysis with MOCUS")
       ("prime-implicants", "Calculate prime implicants")
+      ("reorder", OPT_VALUE(bool), "Reorder BDD variables dynamically")
+      ("bdd-memory", OPT_VALUE(int),
+       "Memory budget (MiB) for BDD computation tables")
+      ("bdd-fork-depth", OPT_VALUE(int),
+       "Depth of the parallel BDD Apply with --threads (0 for serial)")
       ("probability", OPT_VALUE(bool), "Perform probability analysis")
       ("importance", OPT_VALUE(bool), "Perform importance analysis")
       ("uncertainty", OPT_VALUE(bool), "Perform uncertainty analysis")
@@ -76,15 +81,24 @@ po::options_description ConstructOptions() {
       ("mcub", "Use the MCUB approximation")
       ("limit-order,l", OPT_VALUE(int), "Upper limit for the product order")
       ("cut-off", OPT_VALUE(double), "Cut-off probability for products")
+      ("top-products", OPT_VALUE(int),
+       "Report only the given number of the most probable products")
+      ("cache-dir", OPT_VALUE(path),
+       "Directory to reuse the products of unchanged modules")
+      ("monte-carlo", OPT_VALUE(int),
+       "Simulate the probability in the number of trials without products")
       ("mission-time", OPT_VALUE(double), "System mission time in hours")
       ("time-step", OPT_VALUE(double),
        "Time step in hours for probability analysis")
+      ("time-tolerance", OPT_VALUE(double),
+       "Relative error tolerance to refine the time steps adaptively")
       ("num-trials", OPT_VALUE(int),
        "Number of trials for Monte Carlo simulations")
       ("num-quantiles", OPT_VALUE(int),
        "Number of quantiles for distributions")
       ("num-bins", OPT_VALUE(int), "Number of bins for histograms")
       ("seed", OPT_VALUE(int), "Seed for the pseudo-random number generator")
+      ("threads", OPT_VALUE(int), "Number of threads for parallel computations")
       ("output-path,o", OPT_VALUE(path), "Output path for reports")
       ("no-indent", "Omit indentation whitespace in output XML")
       ("verbosity", OPT_VALUE(int), "Set log verbosity");
@@ -207,19 +221,27 @@ void ConstructSettings(const po::variables_map& vm,
     settings->approximation("mcub");
   }
   SET("time-step", double, time_step);
+  SET("time-tolerance", double, time_tolerance);
   SET("sil", bool, safety_integrity_levels);
+  SET("top-products", int, top_products);
+  SET("cache-dir", std::string, cache_directory);
+  SET("monte-carlo", int, monte_carlo);
 
   SET("probability", bool, probability_analysis);
   SET("importance", bool, importance_analysis);
   SET("uncertainty", bool, uncertainty_analysis);
   SET("ccf", bool, ccf_analysis);
   SET("seed", int, seed);
+  SET("reorder", bool, reorder);
+  SET("bdd-memory", int, bdd_memory);
+  SET("bdd-fork-depth", int, bdd_fork_depth);
   SET("limit-order", int, limit_order);
   SET("cut-off", double, cut_off);
   SET("mission-time", double, mission_time);
   SET("num-trials", int, num_trials);
   SET("num-quantiles", int, num_quantiles);
   SET("num-bins", int, num_bins);
+  SET("threads", int, num_threads);
 #ifndef NDEBUG
   settings->preprocessor = vm.count("preprocessor");
   settings->print = vm.count("print");
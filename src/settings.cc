@@ -20,6 +20,8 @@
 
 #include "settings.h"
 
+#include <utility>
+
 #include <boost/range/algorithm.hpp>
 
 #include "error.h"
@@ -72,6 +74,9 @@ Settings& Settings::prime_implicants(bool flag) {
   if (flag && algorithm_ != Algorithm::kBdd)
     SCRAM_THROW(
         SettingsError("Prime implicants can only be calculated with BDD"));
+  if (flag && monte_carlo_)
+    SCRAM_THROW(
+        SettingsError("Prime implicants cannot be found with simulation."));
 
   prime_implicants_ = flag;
   if (prime_implicants_)
@@ -79,6 +84,22 @@ Settings& Settings::prime_implicants(bool flag) {
   return *this;
 }
 
+Settings& Settings::bdd_memory(int megabytes) {
+  if (megabytes < 0)
+    SCRAM_THROW(SettingsError("The BDD memory budget cannot be negative."));
+
+  bdd_memory_ = megabytes;
+  return *this;
+}
+
+Settings& Settings::bdd_fork_depth(int depth) {
+  if (depth < 0)
+    SCRAM_THROW(SettingsError("The BDD fork depth cannot be negative."));
+
+  bdd_fork_depth_ = depth;
+  return *this;
+}
+
 Settings& Settings::limit_order(int order) {
   if (order < 0) {
     SCRAM_THROW(SettingsError("The limit on the order of products "
@@ -96,6 +117,36 @@ Settings& Settings::cut_off(double prob) {
   return *this;
 }
 
+Settings& Settings::top_products(int n) {
+  if (n < 0)
+    SCRAM_THROW(
+        SettingsError("The number of top products cannot be negative."));
+
+  top_products_ = n;
+  if (top_products_)
+    probability_analysis_ = true;
+  return *this;
+}
+
+Settings& Settings::cache_directory(std::string path) {
+  cache_directory_ = std::move(path);
+  return *this;
+}
+
+Settings& Settings::monte_carlo(int n) {
+  if (n < 0)
+    SCRAM_THROW(SettingsError(
+        "The number of trials for simulation cannot be negative."));
+  if (n && prime_implicants_)
+    SCRAM_THROW(
+        SettingsError("Prime implicants cannot be found with simulation."));
+
+  monte_carlo_ = n;
+  if (monte_carlo_)
+    probability_analysis_ = true;
+  return *this;
+}
+
 Settings& Settings::num_trials(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of trials cannot be less than 1."));
@@ -129,6 +180,14 @@ Settings& Settings::seed(int s) {
   return *this;
 }
 
+Settings& Settings::num_threads(int n) {
+  if (n < 1)
+    SCRAM_THROW(SettingsError("The number of threads cannot be less than 1."));
+
+  num_threads_ = n;
+  return *this;
+}
+
 Settings& Settings::mission_time(double time) {
   if (time < 0)
     SCRAM_THROW(SettingsError("The mission time cannot be negative."));
@@ -147,6 +206,15 @@ Settings& Settings::time_step(double time) {
   return *this;
 }
 
+Settings& Settings::time_tolerance(double tolerance) {
+  if (tolerance < 0 || tolerance >= 1)
+    SCRAM_THROW(SettingsError("The time step tolerance cannot be negative or"
+                              " more than or equal to 1."));
+
+  time_tolerance_ = tolerance;
+  return *this;
+}
+
 Settings& Settings::safety_integrity_levels(bool flag) {
   if (flag && !time_step_)
     SCRAM_THROW(
@@ -23,6 +23,8 @@
 
 #include <cstdint>
 
+#include <string>
+
 #include <boost/utility/string_ref.hpp>
 
 namespace scram {
@@ -116,6 +118,51 @@ class Settings {
   /// @throws SettingsError  The request is not relevant to the algorithm.
   Settings& prime_implicants(bool flag);
 
+  /// @returns true if BDD variables must be reordered dynamically.
+  bool reorder() const { return reorder_; }
+
+  /// Sets the flag to reorder BDD variables with sifting
+  /// upon the BDD growth and after the BDD construction.
+  ///
+  /// @param[in] flag  True for the request.
+  ///
+  /// @returns Reference to this object.
+  Settings& reorder(bool flag) {
+    reorder_ = flag;
+    return *this;
+  }
+
+  /// @returns The memory budget in MiB for BDD computation tables.
+  ///          0 for no limit.
+  int bdd_memory() const { return bdd_memory_; }
+
+  /// Sets the memory budget for the tables of BDD computation results.
+  /// The tables stop growing at the budget
+  /// and replace their old entries instead.
+  ///
+  /// @param[in] megabytes  A non-negative number of MiB (0 for no limit).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Settings& bdd_memory(int megabytes);
+
+  /// @returns The depth of the BDD Apply recursion
+  ///          down to which the branches are computed in parallel threads.
+  ///          0 for the serial Apply.
+  int bdd_fork_depth() const { return bdd_fork_depth_; }
+
+  /// Sets the depth of the parallel BDD Apply.
+  /// The branches of the operations above the depth
+  /// are split into tasks for the threads of the analysis.
+  ///
+  /// @param[in] depth  A non-negative depth (0 for the serial Apply).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The depth is negative.
+  Settings& bdd_fork_depth(int depth);
+
   /// @returns The limit on the size of products.
   int limit_order() const { return limit_order_; }
 
@@ -133,14 +180,60 @@ class Settings {
 
   /// Sets the cut-off probability for products
   /// to be considered for analysis.
+  /// The cut-off is applied only with probability analysis.
   ///
-  /// @param[in] prob  The minimum probability for products.
+  /// @param[in] prob  The minimum probability for products (0 for none).
   ///
   /// @returns Reference to this object.
   ///
   /// @throws SettingsError  The probability is not in the [0, 1] range.
   Settings& cut_off(double prob);
 
+  /// @returns The number of the most probable products to report.
+  ///          0 for all the products.
+  int top_products() const { return top_products_; }
+
+  /// Sets the number of the most probable products
+  /// to be extracted for reporting instead of all the products.
+  /// The products are ranked by probability;
+  /// therefore, this setting turns on probability analysis.
+  ///
+  /// @param[in] n  A non-negative number of products (0 for all).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Settings& top_products(int n);
+
+  /// @returns The directory for the persistent cache of module products.
+  const std::string& cache_directory() const { return cache_directory_; }
+
+  /// Sets the directory to store and reuse the products of modules
+  /// across analyses of the same or edited models.
+  ///
+  /// @param[in] path  The path to the cache directory (empty to disable).
+  ///
+  /// @returns Reference to this object.
+  Settings& cache_directory(std::string path);
+
+  /// @returns The number of trials to simulate the total probability.
+  ///          0 if the probability is not simulated.
+  int monte_carlo() const { return monte_carlo_; }
+
+  /// Sets the number of trials to estimate the total probability
+  /// with Monte Carlo simulation of the fault tree
+  /// instead of the qualitative analysis and its products.
+  /// The simulation is a probability analysis;
+  /// therefore, this setting turns on probability analysis.
+  ///
+  /// @param[in] n  A non-negative number of trials (0 for no simulation).
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative
+  ///                          or prime implicants are requested.
+  Settings& monte_carlo(int n);
+
   /// @returns The number of trials for Monte-Carlo simulations.
   int num_trials() const { return num_trials_; }
 
@@ -189,6 +282,19 @@ class Settings {
   /// @throws SettingsError  The number is negative.
   Settings& seed(int s);
 
+  /// @returns The number of threads for parallel computations.
+  int num_threads() const { return num_threads_; }
+
+  /// Sets the number of threads for parallel computations,
+  /// such as Monte Carlo simulations.
+  ///
+  /// @param[in] n  A natural number for the number of threads.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& num_threads(int n);
+
   /// @returns The length time of the system under risk.
   double mission_time() const { return mission_time_; }
 
@@ -217,6 +323,24 @@ class Settings {
   ///                          while the SIL metrics are requested.
   Settings& time_step(double time);
 
+  /// @returns The relative error tolerance
+  ///          to refine the time steps adaptively.
+  ///          0 for the uniform time steps.
+  double time_tolerance() const { return time_tolerance_; }
+
+  /// Sets the tolerance for the adaptive time steps.
+  /// The time step becomes the largest step,
+  /// and the steps are refined until the estimated error
+  /// of the average probability over the mission time
+  /// is within the relative tolerance.
+  ///
+  /// @param[in] tolerance  The relative error tolerance or 0.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The tolerance is not in [0, 1).
+  Settings& time_tolerance(double tolerance);
+
   /// @returns true if probability analysis is requested.
   bool probability_analysis() const { return probability_analysis_; }
 
@@ -309,6 +433,7 @@ class Settings {
   bool uncertainty_analysis_ = false;  ///< A flag for uncertainty analysis.
   bool ccf_analysis_ = false;  ///< A flag for common-cause analysis.
   bool prime_implicants_ = false;  ///< Calculation of prime implicants.
+  bool reorder_ = false;  ///< Dynamic reordering of BDD variables.
   /// Qualitative analysis algorithm.
   Algorithm algorithm_ = Algorithm::kBdd;
   /// The approximations for calculations.
@@ -318,9 +443,16 @@ class Settings {
   int num_trials_ = 1e3;  ///< The number of trials for Monte Carlo simulations.
   int num_quantiles_ = 20;  ///< The number of quantiles for distributions.
   int num_bins_ = 20;  ///< The number of bins for histograms.
+  int num_threads_ = 1;  ///< The number of threads for parallel computations.
+  int bdd_memory_ = 0;  ///< The memory budget (MiB) for BDD computations.
+  int bdd_fork_depth_ = 0;  ///< The depth of the parallel BDD Apply.
+  int top_products_ = 0;  ///< The number of the most probable products.
+  int monte_carlo_ = 0;  ///< The number of trials for probability simulation.
   double mission_time_ = 8760;  ///< System mission time.
   double time_step_ = 0;  ///< The time step for probability analyses.
-  double cut_off_ = 1e-8;  ///< The cut-off probability for products.
+  double time_tolerance_ = 0;  ///< The tolerance for adaptive time steps.
+  double cut_off_ = 0;  ///< The cut-off probability for products.
+  std::string cache_directory_;  ///< The cache directory for module products.
 };
 
 }  // namespace core
@@ -21,7 +21,12 @@
 #include "uncertainty_analysis.h"
 
 #include <cmath>
+#include <cstdint>
 
+#include <algorithm>
+#include <thread>
+
+#include <boost/optional.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/density.hpp>
 #include <boost/accumulators/statistics/extended_p_square_quantile.hpp>
@@ -31,7 +36,10 @@
 
 #include "event.h"
 #include "expression.h"
+#include "expression_tape.h"
 #include "logger.h"
+#include "parallel.h"
+#include "random.h"
 
 namespace scram {
 namespace core {
@@ -59,6 +67,51 @@ void UncertaintyAnalysis::Analyze() noexcept {
   Analysis::AddAnalysisTime(DUR(analysis_time));
 }
 
+std::vector<double> UncertaintyAnalysis::SampleTrials(
+    const Pdag* graph, const Pdag::IndexMap<double>& p_vars,
+    const std::function<std::vector<double>(
+        const std::vector<Pdag::IndexMap<double>>&)>& calculator) noexcept {
+  std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
+      GatherDeviateExpressions(graph);
+  std::vector<mef::Expression*> expressions;
+  for (const auto& expression : deviate_expressions)
+    expressions.push_back(&expression.second);
+  const mef::ExpressionTape tape(expressions, /*sample=*/true);
+  int num_trials = Analysis::settings().num_trials();
+  int target = Random::target();
+  std::vector<double> samples(num_trials);
+  const int kBatchSize = ProbabilityAnalyzerBase::kBatchSize;
+  int num_batches = (num_trials + kBatchSize - 1) / kBatchSize;
+  int num_threads = std::min(Analysis::settings().num_threads(), num_batches);
+  if (num_threads > 1)
+    LOG(DEBUG4) << "Sampling in " << num_threads << " threads...";
+  std::thread::id caller = std::this_thread::get_id();
+  // The batches of trials are split into contiguous chunks per thread.
+  ParallelFor(num_threads, num_threads, [&](std::int64_t chunk) {
+    // Only the calling thread may use the shared sampling state.
+    boost::optional<mef::Expression::ThreadSampling> thread_sampling;
+    if (std::this_thread::get_id() != caller)
+      thread_sampling.emplace();
+    std::vector<Pdag::IndexMap<double>> p_vars_batch;  // Private copies!
+    int last = (chunk + 1) * num_batches / num_threads * kBatchSize;
+    for (int first = chunk * num_batches / num_threads * kBatchSize;
+         first < std::min(last, num_trials); first += kBatchSize) {
+      int batch_size = std::min(kBatchSize, num_trials - first);
+      p_vars_batch.resize(batch_size, p_vars);
+      // The batch of trials is sampled from the stream of its first trial
+      // independent of the thread.
+      Random::stream(target, first);
+      SampleExpressions(deviate_expressions, tape, &p_vars_batch);
+      std::vector<double> results = calculator(p_vars_batch);
+      for (int i = 0; i < batch_size; ++i) {
+        assert(results[i] >= 0 && results[i] <= 1);
+        samples[first + i] = results[i];
+      }
+    }
+  });
+  return samples;
+}
+
 std::vector<std::pair<int, mef::Expression&>>
 UncertaintyAnalysis::GatherDeviateExpressions(const Pdag* graph) noexcept {
   std::vector<std::pair<int, mef::Expression&>> deviate_expressions;
@@ -73,15 +126,18 @@ UncertaintyAnalysis::GatherDeviateExpressions(const Pdag* graph) noexcept {
 
 void UncertaintyAnalysis::SampleExpressions(
     const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
-    Pdag::IndexMap<double>* p_vars) noexcept {
-  // Reset distributions.
-  for (const auto& expression : deviate_expressions)
-    expression.second.Reset();
-
-  // Sample all expressions with distributions.
-  for (const auto& expression : deviate_expressions) {
-    double prob = expression.second.Sample();
-    (*p_vars)[expression.first] = prob > 1 ? 1 : prob < 0 ? 0 : prob;
+    const mef::ExpressionTape& tape,
+    std::vector<Pdag::IndexMap<double>>* p_vars_batch) noexcept {
+  int num_trials = p_vars_batch->size();
+  std::vector<double> samples(tape.size() * num_trials);
+  tape.Evaluate(samples.data(), num_trials);
+  for (int i = 0; i < tape.size(); ++i) {
+    int index = deviate_expressions[i].first;
+    const double* expression_samples = samples.data() + i * num_trials;
+    for (int j = 0; j < num_trials; ++j) {
+      double prob = expression_samples[j];
+      (*p_vars_batch)[j][index] = prob > 1 ? 1 : prob < 0 ? 0 : prob;
+    }
   }
 }
 
@@ -22,6 +22,7 @@
 #ifndef SCRAM_SRC_UNCERTAINTY_ANALYSIS_H_
 #define SCRAM_SRC_UNCERTAINTY_ANALYSIS_H_
 
+#include <functional>
 #include <utility>
 #include <vector>
 
@@ -33,6 +34,7 @@ namespace scram {
 
 namespace mef {  // Decouple from the implementation dependence.
 class Expression;
+class ExpressionTape;
 }  // namespace mef
 
 namespace core {
@@ -79,6 +81,29 @@ class UncertaintyAnalysis : public Analysis {
   const std::vector<double>& quantiles() const { return quantiles_; }
 
  protected:
+  /// Runs Monte Carlo trials to sample the total probability.
+  /// The trials are split among threads (if requested in the settings)
+  /// with their own random number generators,
+  /// expression sampling states,
+  /// and copies of variable probabilities.
+  /// The consecutive trials are sampled and calculated together
+  /// in fixed batches.
+  /// Each batch samples from its own random number stream
+  /// of the analysis target of the current thread,
+  /// so the samples are reproducible for the same seed
+  /// regardless of the number of threads.
+  ///
+  /// @param[in] graph  PDAG with the variables.
+  /// @param[in] p_vars  Indices to probabilities mapping with mean values.
+  /// @param[in] calculator  Thread-safe calculator of the total probabilities
+  ///                        for a batch of trials.
+  ///
+  /// @returns Samples of the total probability in the order of trials.
+  std::vector<double> SampleTrials(
+      const Pdag* graph, const Pdag::IndexMap<double>& p_vars,
+      const std::function<std::vector<double>(
+          const std::vector<Pdag::IndexMap<double>>&)>& calculator) noexcept;
+
   /// Gathers deviate expressions of variables.
   ///
   /// @param[in] graph  PDAG with the variables.
@@ -87,13 +112,16 @@ class UncertaintyAnalysis : public Analysis {
   std::vector<std::pair<int, mef::Expression&>> GatherDeviateExpressions(
       const Pdag* graph) noexcept;
 
-  /// Samples uncertain probabilities.
+  /// Samples uncertain probabilities for a batch of trials.
   ///
   /// @param[in] deviate_expressions  A collection of deviate expressions.
-  /// @param[in,out] p_vars  Indices to probabilities mapping with values.
+  /// @param[in] tape  The deviate expressions compiled for sampling.
+  /// @param[in,out] p_vars_batch  Indices to probabilities mappings
+  ///                              with values for each trial.
   void SampleExpressions(
       const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
-      Pdag::IndexMap<double>* p_vars) noexcept;
+      const mef::ExpressionTape& tape,
+      std::vector<Pdag::IndexMap<double>>* p_vars_batch) noexcept;
 
  private:
   /// Performs Monte Carlo Simulation
@@ -144,20 +172,11 @@ class UncertaintyAnalyzer : public UncertaintyAnalysis {
 
 template <class Calculator>
 std::vector<double> UncertaintyAnalyzer<Calculator>::Sample() noexcept {
-  std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
-      UncertaintyAnalysis::GatherDeviateExpressions(prob_analyzer_->graph());
-  Pdag::IndexMap<double> p_vars = prob_analyzer_->p_vars();  // Private copy!
-  std::vector<double> samples;
-  samples.reserve(Analysis::settings().num_trials());
-
-  for (int i = 0; i < Analysis::settings().num_trials(); ++i) {
-    UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
-    double result = prob_analyzer_->CalculateTotalProbability(p_vars);
-    assert(result >= 0 && result <= 1);
-    samples.push_back(result);
-  }
-
-  return samples;
+  return UncertaintyAnalysis::SampleTrials(
+      prob_analyzer_->graph(), prob_analyzer_->p_vars(),
+      [this](const std::vector<Pdag::IndexMap<double>>& p_vars_batch) {
+        return prob_analyzer_->CalculateTotalProbabilities(p_vars_batch);
+      });
 }
 
 }  // namespace core
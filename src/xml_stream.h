@@ -22,6 +22,7 @@
 #define SCRAM_SRC_XML_STREAM_H_
 
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 
 #include <algorithm>
@@ -108,7 +109,8 @@ class FileStream {
   /// @{
   void write(const std::string& value) { write(value.c_str()); }
   void write(const char* value) { std::fputs(value, file_); }
-  void write(int value) {
+  void write(int value) { write(static_cast<std::int64_t>(value)); }
+  void write(std::int64_t value) {
     if (value < 0) {
       std::fputc('-', file_);
       value = -value;
@@ -21,18 +21,299 @@
 #include "zbdd.h"
 
 #include <cstdlib>
+#include <cstring>
 
 #include <algorithm>
-
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
 #include <boost/range/algorithm.hpp>
 
+#include "event.h"
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
 #include "logger.h"
+#include "parallel.h"
 
 namespace scram {
 namespace core {
 
+std::shared_ptr<const CutOff> CutOff::Create(const Pdag& graph,
+                                             const Settings& settings) {
+  if (!settings.probability_analysis() || settings.cut_off() == 0)
+    return nullptr;
+  return std::make_shared<const CutOff>(graph, settings.cut_off());
+}
+
+CutOff::CutOff(const Pdag& graph, double cut_off) noexcept
+    : limit_(std::floor(-std::log2(cut_off) * kScale)),
+      weights_(graph.basic_events().size()) {
+  assert(cut_off > 0 && cut_off <= 1);
+  // Rounding down the weights never overestimates the weight of products.
+  // Impossible literals are truncated regardless of other literals.
+  auto get_weight = [this](double p) {
+    return p > 0 ? std::min<int>(std::floor(-std::log2(p) * kScale), limit_ + 1)
+                 : limit_ + 1;
+  };
+  int index = Pdag::kVariableStartIndex;
+  for (const mef::BasicEvent* event : graph.basic_events()) {
+    double p = event->p();
+    weights_[index++] = {get_weight(p), get_weight(1 - p)};
+  }
+}
+
+namespace {
+
+/// Stable 128-bit hash of data
+/// independent of the platform, the process, and the model indices.
+class StableHash {
+ public:
+  /// Appends an integer to the hashed data.
+  StableHash& operator<<(std::uint64_t value) noexcept {
+    for (int i = 0; i < 8; ++i, value >>= 8)
+      Add(value & 0xFF);
+    return *this;
+  }
+
+  /// Appends a string to the hashed data.
+  StableHash& operator<<(const std::string& value) noexcept {
+    *this << value.size();
+    for (unsigned char byte : value)
+      Add(byte);
+    return *this;
+  }
+
+  /// @returns The hash of the appended data.
+  std::array<std::uint64_t, 2> hash() const { return {{fnv_, mix_}}; }
+
+ private:
+  /// Mixes a byte into both halves of the hash.
+  void Add(std::uint64_t byte) noexcept {
+    fnv_ = (fnv_ ^ byte) * 0x100000001b3;  // FNV-1a.
+    mix_ = (mix_ + byte + 1) * 0x9e3779b97f4a7c15;
+    mix_ ^= mix_ >> 29;
+  }
+
+  std::uint64_t fnv_ = 0xcbf29ce484222325;  ///< The FNV-1a hash.
+  std::uint64_t mix_ = 0x6a09e667f3bcc909;  ///< The multiplicative hash.
+};
+
+/// @returns The bits of a floating-point value for hashing.
+std::uint64_t Bits(double value) noexcept {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+/// Writes a fixed-size value in binary.
+template <typename T>
+void Write(std::ostream& stream, T value) noexcept {
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/// Reads a fixed-size value in binary.
+///
+/// @returns false if the stream is exhausted or bad.
+template <typename T>
+bool Read(std::istream& stream, T* value) noexcept {
+  return static_cast<bool>(
+      stream.read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+const char kCacheMagic[] = "SCRAMZC1";  ///< The header of cache entries.
+const std::uint32_t kMaxIdLength = 1 << 16;  ///< Sanity limit on event IDs.
+
+}  // namespace
+
+std::shared_ptr<const ModuleCache> ModuleCache::Create(
+    const Pdag& graph, const Settings& settings) {
+  if (settings.cache_directory().empty())
+    return nullptr;
+  boost::system::error_code error;
+  boost::filesystem::create_directories(settings.cache_directory(), error);
+  if (error) {
+    LOG(WARNING) << "The module cache is disabled: "
+                 << settings.cache_directory() << ": " << error.message();
+    return nullptr;
+  }
+  return std::make_shared<const ModuleCache>(graph, settings);
+}
+
+ModuleCache::ModuleCache(const Pdag& graph, const Settings& settings) noexcept
+    : graph_(graph), directory_(settings.cache_directory()) {
+  int index = Pdag::kVariableStartIndex;
+  for (const mef::BasicEvent* event : graph.basic_events())
+    indices_.emplace(event->id(), index++);
+  // Only the probability cut-off makes the products depend on probabilities.
+  HashGate(graph.root(),
+           settings.probability_analysis() && settings.cut_off() != 0);
+}
+
+ModuleCache::Hash ModuleCache::HashGate(const Gate& gate,
+                                        bool probabilities) noexcept {
+  auto it = hashes_.find(gate.index());
+  if (it != hashes_.end())
+    return it->second;
+  std::vector<Hash> args;  // Sorted to be independent of indices.
+  for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
+    Hash sub = HashGate(arg.second, probabilities);
+    args.push_back((StableHash() << (arg.first < 0) << sub[0] << sub[1])
+                       .hash());
+  }
+  for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
+    const mef::BasicEvent& event =
+        *graph_.basic_events()[arg.second.index()];
+    StableHash hash;
+    hash << (arg.first < 0) << event.id();
+    if (probabilities)
+      hash << Bits(event.p());
+    args.push_back(hash.hash());
+  }
+  std::sort(args.begin(), args.end());
+  StableHash hash;
+  hash << static_cast<std::uint64_t>(gate.type()) << gate.vote_number()
+       << gate.constant() << gate.module() << args.size();
+  for (const Hash& arg : args)
+    hash << arg[0] << arg[1];
+  return hashes_.emplace(gate.index(), hash.hash()).first->second;
+}
+
+std::string ModuleCache::Key(const Gate& gate, const Settings& settings) const
+    noexcept {
+  assert(hashes_.count(gate.index()) && "The gate is not in the graph.");
+  const Hash& structure = hashes_.find(gate.index())->second;
+  double cut_off = settings.probability_analysis() ? settings.cut_off() : 0;
+  Hash hash = (StableHash() << std::string(kCacheMagic) << structure[0]
+                            << structure[1]
+                            << static_cast<std::uint64_t>(settings.algorithm())
+                            << settings.prime_implicants()
+                            << settings.limit_order() << Bits(cut_off))
+                  .hash();
+  std::ostringstream key;
+  key << std::hex << std::setfill('0') << std::setw(16) << hash[0]
+      << std::setw(16) << hash[1];
+  return key.str();
+}
+
+bool ModuleCache::Load(const std::string& key,
+                       std::vector<Zbdd::FlatNode>* nodes, int* root,
+                       double* truncated_mass) const noexcept {
+  std::ifstream file((boost::filesystem::path(directory_) / key).string(),
+                     std::ios::binary);
+  if (!file)
+    return false;
+  char magic[sizeof(kCacheMagic) - 1];
+  if (!file.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kCacheMagic, sizeof(magic)))
+    return false;
+  std::uint32_t num_ids = 0;
+  if (!Read(file, &num_ids))
+    return false;
+  std::vector<int> indices;  // The variable indices of the event IDs.
+  std::string id;
+  for (std::uint32_t i = 0; i < num_ids; ++i) {
+    std::uint32_t length = 0;
+    if (!Read(file, &length) || length > kMaxIdLength)
+      return false;
+    id.resize(length);
+    if (!file.read(&id[0], length))
+      return false;
+    auto it = indices_.find(id);
+    if (it == indices_.end())
+      return false;  // The model is edited.
+    indices.push_back(it->second);
+  }
+  double mass = 0;
+  std::int32_t root_position = 0;
+  std::uint32_t num_nodes = 0;
+  if (!Read(file, &mass) || !Read(file, &root_position) ||
+      !Read(file, &num_nodes))
+    return false;
+  auto valid = [&nodes](std::int32_t position) {
+    return position == Zbdd::kBasePosition ||
+           position == Zbdd::kEmptyPosition ||
+           (position >= 0 && position < nodes->size());
+  };
+  nodes->clear();
+  for (std::uint32_t i = 0; i < num_nodes; ++i) {
+    std::int32_t index = 0, high = 0, low = 0;
+    std::uint8_t module = 0;
+    if (!Read(file, &index) || !Read(file, &high) || !Read(file, &low) ||
+        !Read(file, &module) || !valid(high) || !valid(low))
+      return false;
+    if (module) {
+      if (!valid(index))
+        return false;
+    } else {
+      int slot = std::abs(index);
+      if (slot == 0 || slot > indices.size())
+        return false;
+      index = index < 0 ? -indices[slot - 1] : indices[slot - 1];
+    }
+    nodes->push_back({index, high, low, module != 0});
+  }
+  if (!valid(root_position) || file.peek() != std::ifstream::traits_type::eof())
+    return false;
+  *root = root_position;
+  *truncated_mass = mass;
+  return true;
+}
+
+void ModuleCache::Store(const std::string& key, const Zbdd& products) const
+    noexcept {
+  std::vector<Zbdd::FlatNode> nodes;
+  int root = products.Flatten(&nodes);
+  // The IDs of events are stored instead of the graph-specific indices.
+  std::unordered_map<int, int> slots;
+  std::vector<const std::string*> ids;
+  for (Zbdd::FlatNode& node : nodes) {
+    if (node.module)
+      continue;
+    auto it = slots.emplace(std::abs(node.index), ids.size() + 1);
+    if (it.second)
+      ids.push_back(&graph_.basic_events()[std::abs(node.index)]->id());
+    node.index = node.index < 0 ? -it.first->second : it.first->second;
+  }
+  namespace fs = boost::filesystem;
+  fs::path target = fs::path(directory_) / key;
+  boost::system::error_code error;
+  fs::path temp = fs::unique_path(target.string() + ".%%%%-%%%%", error);
+  if (!error) {
+    std::ofstream file(temp.string(), std::ios::binary);
+    file.write(kCacheMagic, sizeof(kCacheMagic) - 1);
+    Write<std::uint32_t>(file, ids.size());
+    for (const std::string* id : ids) {
+      Write<std::uint32_t>(file, id->size());
+      file.write(id->data(), id->size());
+    }
+    Write<double>(file, products.truncated_mass());
+    Write<std::int32_t>(file, root);
+    Write<std::uint32_t>(file, nodes.size());
+    for (const Zbdd::FlatNode& node : nodes) {
+      Write<std::int32_t>(file, node.index);
+      Write<std::int32_t>(file, node.high);
+      Write<std::int32_t>(file, node.low);
+      Write<std::uint8_t>(file, node.module);
+    }
+    file.close();
+    if (!file)
+      error = boost::system::errc::make_error_code(
+          boost::system::errc::io_error);
+    else
+      fs::rename(temp, target, error);  // Atomic for concurrent readers.
+  }
+  if (error) {
+    LOG(WARNING) << "Failed to store module products in the cache: "
+                 << target.string() << ": " << error.message();
+    fs::remove(temp, error);
+  }
+}
+
 #ifndef NDEBUG
 /// Runs assertions on ZBDD structure.
 ///
@@ -49,6 +330,9 @@ void Zbdd::Log() noexcept {
   CHECK_ZBDD(false);
   LOG(DEBUG4) << "# of ZBDD nodes created: " << set_id_ - 1;
   LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
+  LOG(DEBUG4) << "Hits/misses/collisions in unique table: "
+              << unique_table_.hits() << "/" << unique_table_.misses() << "/"
+              << unique_table_.collisions();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
   LOG(DEBUG4) << "# of entries in subsume table: " << subsume_table_.size();
@@ -66,7 +350,8 @@ Zbdd::Zbdd(Bdd* bdd, const Settings& settings) noexcept
 }
 
 Zbdd::Zbdd(const Pdag* graph, const Settings& settings) noexcept
-    : Zbdd(graph->root(), settings) {
+    : Zbdd(graph->root(), settings, CutOff::Create(*graph, settings),
+           ModuleCache::Create(*graph, settings)) {
   assert(!graph->complement() && "Complements must be propagated.");
   if (graph->IsTrivial()) {
     const Gate& top_gate = graph->root();
@@ -86,6 +371,8 @@ Zbdd::Zbdd(const Pdag* graph, const Settings& settings) noexcept
 }
 
 void Zbdd::Analyze() noexcept {
+  if (final_)
+    return;  // Restored from the cache.
   CLOCK(zbdd_time);
   assert(root_->terminal() ||
          SetNode::Ref(root_).max_set_order() <= kSettings_.limit_order());
@@ -94,20 +381,379 @@ void Zbdd::Analyze() noexcept {
   for (const auto& entry : modules_)
     entry.second->Analyze();
 
-  Prune(root_, kSettings_.limit_order());
+  Prune(root_, kSettings_.limit_order(), Zbdd::max_weight());
   Freeze();  // Complete cleanup of the memory.
+  final_ = true;
+  if (!cache_key_.empty())
+    cache_->Store(cache_key_, *this);
   LOG(DEBUG3) << "G" << module_index_ << " analysis time: " << DUR(zbdd_time);
 }
 
-Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index) noexcept
+bool Zbdd::LoadModule(const Gate& gate) noexcept {
+  if (!cache_)
+    return false;
+  assert(root_ == kEmpty_ && modules_.empty() && "The ZBDD is not empty.");
+  cache_key_ = cache_->Key(gate, kSettings_);
+  std::vector<FlatNode> nodes;
+  int root = kEmptyPosition;
+  if (!cache_->Load(cache_key_, &nodes, &root, &truncated_mass_))
+    return false;
+  std::unordered_map<int, VertexPtr> vertices;
+  root_ = Restore(nodes, root, cache_->module_base(), &vertices);
+  Freeze();
+  final_ = true;
+  LOG(DEBUG3) << "Loaded module G" << gate.index() << " from the cache.";
+  return true;
+}
+
+Zbdd::VertexPtr Zbdd::Restore(
+    const std::vector<FlatNode>& nodes, int position, int module_base,
+    std::unordered_map<int, VertexPtr>* vertices) noexcept {
+  if (position == kBasePosition)
+    return kBase_;
+  if (position == kEmptyPosition)
+    return kEmpty_;
+  VertexPtr& result = (*vertices)[position];
+  if (result)
+    return result;
+  const FlatNode& node = nodes[position];
+  int index = node.index;
+  if (node.module) {
+    index = module_base + node.index;
+    if (!modules_.count(index)) {
+      std::unique_ptr<Zbdd> module(new Zbdd(kSettings_, coherent_, index));
+      std::unordered_map<int, VertexPtr> module_vertices;
+      module->root_ =
+          module->Restore(nodes, node.index, module_base, &module_vertices);
+      module->Freeze();
+      module->final_ = true;
+      modules_.emplace(index, std::move(module));
+    }
+  }
+  // The orders only need to be consistent with the flattened graph.
+  SetNodePtr vertex = FindOrAddVertex(
+      index, Restore(nodes, node.high, module_base, vertices),
+      Restore(nodes, node.low, module_base, vertices), nodes.size() - position,
+      node.module, coherent_);
+  vertex->minimal(true);
+  result = vertex;
+  return result;
+}
+
+Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index,
+           std::shared_ptr<const CutOff> cut_off,
+           std::shared_ptr<const ModuleCache> cache) noexcept
     : kBase_(new Terminal<SetNode>(true)),
       kEmpty_(new Terminal<SetNode>(false)),
       kSettings_(settings),
       root_(kEmpty_),
       coherent_(coherent),
       module_index_(module_index),
+      cut_off_(std::move(cut_off)),
+      cache_(std::move(cache)),
+      final_(false),
+      truncated_mass_(0),
       set_id_(2) {}
 
+double Zbdd::truncated_mass() const noexcept {
+  double mass = truncated_mass_;
+  for (const auto& entry : modules_)
+    mass += entry.second->truncated_mass();
+  return mass;
+}
+
+const int Zbdd::kBasePosition;
+const int Zbdd::kEmptyPosition;
+
+int Zbdd::Flatten(std::vector<FlatNode>* nodes) const noexcept {
+  std::unordered_map<const SetNode*, int> positions;
+  return Flatten(root_, nodes, &positions);
+}
+
+int Zbdd::Flatten(const VertexPtr& vertex, std::vector<FlatNode>* nodes,
+                  std::unordered_map<const SetNode*, int>* positions) const
+    noexcept {
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? kBasePosition
+                                                  : kEmptyPosition;
+  const SetNode& node = SetNode::Ref(vertex);
+  auto it = positions->find(&node);
+  if (it != positions->end())
+    return it->second;
+  FlatNode flat_node{};
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    flat_node.index = module.Flatten(module.root_, nodes, positions);
+    flat_node.module = true;
+  } else {
+    flat_node.index = node.index();
+  }
+  flat_node.high = Flatten(node.high(), nodes, positions);
+  flat_node.low = Flatten(node.low(), nodes, positions);
+  int position = nodes->size();
+  nodes->push_back(flat_node);
+  positions->emplace(&node, position);
+  return position;
+}
+
+template <class F>
+std::vector<double> Zbdd::SumProducts(F weight) const noexcept {
+  std::vector<FlatNode> nodes;
+  int root = Flatten(&nodes);
+  // The sizes of the largest products regardless of the limit order.
+  std::vector<int> orders(nodes.size());  // -1 for no products.
+  auto get_order = [&orders](int position) {
+    return position == kBasePosition
+               ? 0
+               : position == kEmptyPosition ? -1 : orders[position];
+  };
+  for (int i = 0; i < nodes.size(); ++i) {
+    const FlatNode& node = nodes[i];
+    int high = get_order(node.high);
+    int var = node.module ? get_order(node.index) : 1;
+    orders[i] = std::max(high < 0 || var < 0 ? -1 : high + var,
+                         get_order(node.low));
+  }
+  int width = std::min(get_order(root), kSettings_.limit_order()) + 1;
+  if (width <= 0)
+    return {};
+
+  std::vector<double> sums(nodes.size() * width);
+  std::vector<double> base(width);
+  base.front() = 1;
+  std::vector<double> empty(width);
+  auto retrieve = [&](int position) {
+    return position == kBasePosition
+               ? base.data()
+               : position == kEmptyPosition ? empty.data()
+                                            : sums.data() + position * width;
+  };
+  for (int i = 0; i < nodes.size(); ++i) {
+    const FlatNode& node = nodes[i];
+    const double* high = retrieve(node.high);
+    const double* low = retrieve(node.low);
+    double* result = retrieve(i);
+    result[0] = low[0];
+    if (node.module) {  // The module and high products are joined.
+      const double* module = retrieve(node.index);
+      for (int k = 1; k < width; ++k) {
+        result[k] = low[k];
+        for (int j = 1; j <= k; ++j)
+          result[k] += module[j] * high[k - j];
+      }
+    } else {
+      double w = weight(node.index);
+      for (int k = 1; k < width; ++k)
+        result[k] = low[k] + w * high[k - 1];
+    }
+  }
+  const double* result = retrieve(root);
+  return std::vector<double>(result, result + width);
+}
+
+std::vector<std::int64_t> Zbdd::Distribution() const noexcept {
+  std::vector<double> counts = SumProducts([](int) { return 1; });
+  while (!counts.empty() && counts.back() == 0)
+    counts.pop_back();
+  std::vector<std::int64_t> distribution;
+  distribution.reserve(counts.size());
+  for (double count : counts)
+    distribution.push_back(std::llround(count));
+  return distribution;
+}
+
+double Zbdd::CalculateProbabilitySum(const Pdag::IndexMap<double>& p_vars) const
+    noexcept {
+  std::vector<double> sums = SumProducts([&p_vars](int index) {
+    return index > 0 ? p_vars[index] : 1 - p_vars[-index];
+  });
+  return std::accumulate(sums.begin(), sums.end(), 0.0);
+}
+
+std::vector<int> Zbdd::GatherVariables() const noexcept {
+  std::vector<FlatNode> nodes;
+  int root = Flatten(&nodes);
+  if (root < 0)
+    return {};
+  const int kInfinity = std::numeric_limits<int>::max() / 2;
+  // The sizes of the smallest products in sub-graphs.
+  std::vector<int> min_orders(nodes.size());
+  auto get_min = [&min_orders, kInfinity](int position) {
+    return position == kBasePosition
+               ? 0
+               : position == kEmptyPosition ? kInfinity
+                                            : min_orders[position];
+  };
+  for (int i = 0; i < nodes.size(); ++i) {
+    const FlatNode& node = nodes[i];
+    int var = node.module ? get_min(node.index) : 1;
+    min_orders[i] = std::min({var + get_min(node.high), get_min(node.low),
+                              kInfinity});
+  }
+  // The smallest number of literals outside sub-graphs to complete products.
+  std::vector<int> outer(nodes.size(), kInfinity);
+  auto relax = [&outer](int position, int size) {
+    if (position >= 0)
+      outer[position] = std::min(outer[position], size);
+  };
+  outer[root] = 0;
+  std::vector<int> variables;
+  for (int i = nodes.size() - 1; i >= 0; --i) {  // Parents before children.
+    const FlatNode& node = nodes[i];
+    int context = outer[i];
+    relax(node.low, context);
+    if (node.module) {
+      relax(node.index, context + get_min(node.high));
+      relax(node.high, context + get_min(node.index));
+    } else {
+      relax(node.high, context + 1);
+      if (context + 1 + get_min(node.high) <= kSettings_.limit_order())
+        variables.push_back(std::abs(node.index));
+    }
+  }
+  boost::sort(variables);
+  variables.erase(std::unique(variables.begin(), variables.end()),
+                  variables.end());
+  return variables;
+}
+
+namespace {
+
+/// @param[in] index  Positive or negative index of a variable.
+///
+/// @returns The order of the literal in the ZBDD of extracted products.
+int LiteralOrder(int index) { return 2 * std::abs(index) + (index < 0); }
+
+}  // namespace
+
+std::unique_ptr<Zbdd> Zbdd::TopProducts(
+    int num_products, const Pdag::IndexMap<double>& p_vars) const noexcept {
+  assert(num_products > 0 && "No products to extract.");
+  std::vector<FlatNode> nodes;
+  int root = Flatten(&nodes);
+  std::vector<double> p_max(nodes.size());  // The most probable products.
+  auto retrieve = [&p_max](int position) {
+    return position == kBasePosition
+               ? 1
+               : position == kEmptyPosition ? 0 : p_max[position];
+  };
+  auto p_literal = [&p_vars, &retrieve](const FlatNode& node) {
+    if (node.module)
+      return retrieve(node.index);
+    return node.index > 0 ? p_vars[node.index] : 1 - p_vars[-node.index];
+  };
+  for (int i = 0; i < nodes.size(); ++i) {
+    const FlatNode& node = nodes[i];
+    p_max[i] = std::max(p_literal(node) * retrieve(node.high),
+                        retrieve(node.low));
+  }
+
+  // Partial products share their literals and pending sub-graphs
+  // in linked stacks with the top cell at the back.
+  std::vector<std::pair<int, int>> literals;  // The index and the next cell.
+  struct Pending {
+    int position;  ///< The flat node of the sub-graph yet to be traversed.
+    int next;  ///< The next pending sub-graph or -1.
+    double p;  ///< The bound on products of all the pending sub-graphs.
+  };
+  std::vector<Pending> pending;
+  auto bound = [&pending](int top) { return top < 0 ? 1 : pending[top].p; };
+  auto add_pending = [&](int position, int next) {
+    if (position == kBasePosition)
+      return next;
+    pending.push_back({position, next, retrieve(position) * bound(next)});
+    return static_cast<int>(pending.size()) - 1;
+  };
+  struct Path {
+    double bound;  ///< The upper bound on the probability of its products.
+    double p;  ///< The probability of the literals in the path.
+    int size;  ///< The number of literals in the path.
+    int literals;  ///< The top of the literal stack or -1.
+    int pending;  ///< The top of the pending sub-graph stack or -1.
+    std::int64_t id;  ///< The creation order to break ties.
+  };
+  auto less_probable = [](const Path& lhs, const Path& rhs) {
+    return lhs.bound < rhs.bound ||
+           (lhs.bound == rhs.bound && lhs.id > rhs.id);
+  };
+  std::priority_queue<Path, std::vector<Path>, decltype(less_probable)> paths(
+      less_probable);
+  std::int64_t num_paths = 0;
+  auto add_path = [&](double p, int size, int top_literal, int top_pending) {
+    paths.push({p * bound(top_pending), p, size, top_literal, top_pending,
+                num_paths++});
+  };
+
+  std::vector<std::vector<int>> products;
+  if (root != kEmptyPosition)
+    add_path(1, 0, -1, add_pending(root, -1));
+  // The bounds are exact for complete paths,
+  // so complete paths come out of the queue in the order of probabilities.
+  while (!paths.empty() && products.size() < num_products) {
+    Path path = paths.top();
+    paths.pop();
+    if (path.pending < 0) {
+      std::vector<int> product;
+      for (int i = path.literals; i >= 0; i = literals[i].second)
+        product.push_back(literals[i].first);
+      products.push_back(std::move(product));
+      continue;
+    }
+    if (path.size >= kSettings_.limit_order())
+      continue;  // Any pending sub-graph adds at least one literal.
+    const FlatNode& node = nodes[pending[path.pending].position];
+    int rest = pending[path.pending].next;
+    if (node.low != kEmptyPosition)
+      add_path(path.p, path.size, path.literals, add_pending(node.low, rest));
+    if (node.high == kEmptyPosition)
+      continue;
+    if (node.module) {  // The module products are joined with the high ones.
+      add_path(path.p, path.size, path.literals,
+               add_pending(node.index, add_pending(node.high, rest)));
+    } else {
+      literals.emplace_back(node.index, path.literals);
+      add_path(path.p * p_literal(node), path.size + 1, literals.size() - 1,
+               add_pending(node.high, rest));
+    }
+  }
+  LOG(DEBUG4) << "Searched " << num_paths << " paths for "
+              << products.size() << " products.";
+
+  auto less_order = [](int lhs, int rhs) {
+    return LiteralOrder(lhs) < LiteralOrder(rhs);
+  };
+  for (std::vector<int>& product : products)
+    boost::sort(product, less_order);
+  boost::sort(products, [&less_order](const std::vector<int>& lhs,
+                                      const std::vector<int>& rhs) {
+    return boost::lexicographical_compare(lhs, rhs, less_order);
+  });
+  std::unique_ptr<Zbdd> container(new Zbdd(kSettings_, coherent_));
+  container->root_ =
+      container->ConvertProducts(products.begin(), products.end(), 0);
+  container->Freeze();
+  return container;
+}
+
+Zbdd::VertexPtr Zbdd::ConvertProducts(
+    std::vector<std::vector<int>>::const_iterator first,
+    std::vector<std::vector<int>>::const_iterator last,
+    int position) noexcept {
+  if (first == last)
+    return kEmpty_;
+  if (first->size() == position) {
+    assert(std::next(first) == last && "Non-minimal products.");
+    return kBase_;
+  }
+  int index = (*first)[position];
+  auto it = std::find_if(first, last, [index, position](const auto& product) {
+    return product[position] != index;
+  });
+  VertexPtr high = ConvertProducts(first, it, position + 1);
+  VertexPtr low = ConvertProducts(it, last, position);
+  return FindOrAddVertex(index, high, low, LiteralOrder(index));
+}
+
 Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
            const Settings& settings, int module_index) noexcept
     : Zbdd(settings, coherent, module_index) {
@@ -122,11 +768,12 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
   LOG(DEBUG2) << "Created ZBDD from BDD in " << DUR(init_time);
   std::map<int, std::pair<bool, int>> sub_modules;
   GatherModules(root_, 0, &sub_modules);
+  std::vector<std::pair<int, Bdd::Function>> subs;  // Modules to convert.
   for (const auto& entry : sub_modules) {
     int index = entry.first;
     assert(!modules_.count(index) && "Recalculating modules.");
     Bdd::Function sub = bdd->modules().find(std::abs(index))->second;
-    assert(!sub.vertex->terminal() && "Unexpected BDD terminal vertex.");
+    assert(!Bdd::terminal(sub.vertex) && "Unexpected BDD terminal vertex.");
     int limit = entry.second.second;
     assert(limit >= 0 && "Order cut-off is not strict.");
     bool module_coherence = entry.second.first && (index > 0);
@@ -134,12 +781,24 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
       JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(settings)));
       continue;
     }
-    Settings adjusted(settings);
-    adjusted.limit_order(limit);
     sub.complement ^= index < 0;
-    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(sub, module_coherence, bdd,
-                                                     adjusted, index)));
+    subs.emplace_back(index, std::move(sub));
   }
+  // Independent modules share no BDD vertices except the terminal;
+  // however, prime implicants need the BDD facilities.
+  int num_threads = bdd->coherent() ? settings.num_threads() : 1;
+  std::vector<std::unique_ptr<Zbdd>> containers(subs.size());
+  ParallelFor(num_threads, subs.size(), [&](int i) {
+    int index = subs[i].first;
+    const std::pair<bool, int>& entry = sub_modules.find(index)->second;
+    Settings adjusted(settings);
+    adjusted.limit_order(entry.second);
+    adjusted.num_threads(std::max<int>(1, num_threads / subs.size()));
+    containers[i].reset(new Zbdd(subs[i].second, entry.first && (index > 0),
+                                 bdd, adjusted, index));
+  });
+  for (int i = 0; i < subs.size(); ++i)
+    JoinModule(subs[i].first, std::move(containers[i]));
   if (ext::any_of(modules_, [](const ModuleEntry& member) {
         return member.second->root_->terminal();
       })) {
@@ -149,10 +808,15 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
   }
 }
 
-Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
-    : Zbdd(settings, gate.coherent(), gate.index()) {
+Zbdd::Zbdd(const Gate& gate, const Settings& settings,
+           std::shared_ptr<const CutOff> cut_off,
+           std::shared_ptr<const ModuleCache> cache) noexcept
+    : Zbdd(settings, gate.coherent(), gate.index(), std::move(cut_off),
+           std::move(cache)) {
   if (gate.constant() || gate.type() == kNull)
     return;
+  if (LoadModule(gate))
+    return;
   assert(!settings.prime_implicants() && "Not implemented.");
   CLOCK(init_time);
   assert(gate.module() && "The constructor is meant for module gates.");
@@ -172,6 +836,7 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
   LOG(DEBUG3) << "Finished module conversion to ZBDD in " << DUR(init_time);
   std::map<int, std::pair<bool, int>> sub_modules;
   GatherModules(root_, 0, &sub_modules);
+  std::vector<std::pair<int, int>> subs;  // Modules to convert with limits.
   for (const auto& entry : sub_modules) {
     int index = entry.first;
     assert(index > 0 && "No complement gates.");
@@ -183,11 +848,20 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
       JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(settings)));
       continue;
     }
-    const Gate* module_gate = module_gates.find(index)->second;
-    Settings adjusted(settings);
-    adjusted.limit_order(limit);
-    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(*module_gate, adjusted)));
+    subs.emplace_back(index, limit);
   }
+  // The PDAG is only read by the conversion of independent modules.
+  int num_threads = settings.num_threads();
+  std::vector<std::unique_ptr<Zbdd>> containers(subs.size());
+  ParallelFor(num_threads, subs.size(), [&](int i) {
+    const Gate* module_gate = module_gates.find(subs[i].first)->second;
+    Settings adjusted(settings);
+    adjusted.limit_order(subs[i].second);
+    adjusted.num_threads(std::max<int>(1, num_threads / subs.size()));
+    containers[i].reset(new Zbdd(*module_gate, adjusted, cut_off_, cache_));
+  });
+  for (int i = 0; i < subs.size(); ++i)
+    JoinModule(subs[i].first, std::move(containers[i]));
   EliminateConstantModules();
 }
 
@@ -229,7 +903,7 @@ SetNodePtr Zbdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
                          gate.coherent());
 }
 
-Zbdd::VertexPtr Zbdd::GetReducedVertex(const ItePtr& ite, bool complement,
+Zbdd::VertexPtr Zbdd::GetReducedVertex(const Ite& ite, bool complement,
                                        const VertexPtr& high,
                                        const VertexPtr& low) noexcept {
   if (high->id() == low->id())
@@ -238,10 +912,9 @@ Zbdd::VertexPtr Zbdd::GetReducedVertex(const ItePtr& ite, bool complement,
     return low;
   if (low->terminal() && Terminal<SetNode>::Ref(low).value())
     return low;
-  assert(ite->index() > 0 && "BDD indices are never negative.");
-  return FindOrAddVertex(complement ? -ite->index() : ite->index(),
-                         high, low, ite->order(), ite->module(),
-                         ite->coherent());
+  assert(ite.index() > 0 && "BDD indices are never negative.");
+  return FindOrAddVertex(complement ? -ite.index() : ite.index(), high, low,
+                         ite.order(), ite.module(), ite.coherent());
 }
 
 Zbdd::VertexPtr Zbdd::GetReducedVertex(const SetNodePtr& node,
@@ -258,34 +931,33 @@ Zbdd::VertexPtr Zbdd::GetReducedVertex(const SetNodePtr& node,
   return FindOrAddVertex(node, high, low);
 }
 
-Zbdd::VertexPtr Zbdd::ConvertBdd(const Bdd::VertexPtr& vertex, bool complement,
+Zbdd::VertexPtr Zbdd::ConvertBdd(Bdd::Handle vertex, bool complement,
                                  Bdd* bdd_graph, int limit_order,
                                  PairTable<VertexPtr>* ites) noexcept {
-  if (vertex->terminal())
+  if (Bdd::terminal(vertex))
     return complement ? kEmpty_ : kBase_;
-  VertexPtr& result =
-      (*ites)[{complement ? -vertex->id() : vertex->id(), limit_order}];
+  int id = vertex;
+  VertexPtr& result = (*ites)[{complement ? -id : id, limit_order}];
   if (result)
     return result;
-  if (!coherent_ && kSettings_.prime_implicants()) {
-    result = ConvertBddPrimeImplicants(Ite::Ptr(vertex), complement, bdd_graph,
+  const Ite& ite = bdd_graph->ite(vertex);
+  if ((!coherent_ && kSettings_.prime_implicants()) ||
+      (ite.module() && !ite.coherent())) {
+    result = ConvertBddPrimeImplicants(vertex, complement, bdd_graph,
                                        limit_order, ites);
   } else {
-    result =
-        ConvertBdd(Ite::Ptr(vertex), complement, bdd_graph, limit_order, ites);
+    result = ConvertBdd(ite, complement, bdd_graph, limit_order, ites);
   }
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
   return result;
 }
 
-Zbdd::VertexPtr Zbdd::ConvertBdd(const ItePtr& ite, bool complement,
+Zbdd::VertexPtr Zbdd::ConvertBdd(const Ite& ite, bool complement,
                                  Bdd* bdd_graph, int limit_order,
                                  PairTable<VertexPtr>* ites) noexcept {
-  if (ite->module() && !ite->coherent())
-    return ConvertBddPrimeImplicants(ite, complement, bdd_graph, limit_order,
-                                     ites);
-  VertexPtr low = ConvertBdd(ite->low(), ite->complement_edge() ^ complement,
+  assert(!(ite.module() && !ite.coherent()) && "Only through PI.");
+  VertexPtr low = ConvertBdd(ite.low(), ite.complement_edge() ^ complement,
                              bdd_graph, limit_order, ites);
   if (limit_order == 0) {  // Cut-off on the set order.
     if (low->terminal())
@@ -293,15 +965,16 @@ Zbdd::VertexPtr Zbdd::ConvertBdd(const ItePtr& ite, bool complement,
     return kEmpty_;
   }
   VertexPtr high =
-      ConvertBdd(ite->high(), complement, bdd_graph, --limit_order, ites);
+      ConvertBdd(ite.high(), complement, bdd_graph, --limit_order, ites);
   return GetReducedVertex(ite, false, high, low);
 }
 
 Zbdd::VertexPtr
-Zbdd::ConvertBddPrimeImplicants(const ItePtr& ite, bool complement,
+Zbdd::ConvertBddPrimeImplicants(Bdd::Handle vertex, bool complement,
                                 Bdd* bdd_graph, int limit_order,
                                 PairTable<VertexPtr>* ites) noexcept {
-  Bdd::Function common = Bdd::Consensus()(bdd_graph, ite, complement);
+  const Ite& ite = bdd_graph->ite(vertex);
+  Bdd::Function common = Bdd::Consensus()(bdd_graph, vertex, complement);
   VertexPtr consensus = ConvertBdd(common.vertex, common.complement, bdd_graph,
                                    limit_order, ites);
   if (limit_order == 0) {  // Cut-off on the product order.
@@ -310,13 +983,13 @@ Zbdd::ConvertBddPrimeImplicants(const ItePtr& ite, bool complement,
     return kEmpty_;
   }
   int sublimit = limit_order - 1;  // Assumes non-Unity element.
-  if (ite->module() && !kSettings_.prime_implicants()) {
-    assert(!ite->coherent() && "Only non-coherent modules through PI.");
+  if (ite.module() && !kSettings_.prime_implicants()) {
+    assert(!ite.coherent() && "Only non-coherent modules through PI.");
     sublimit += 1;  // Unity modules may happen with minimal cut sets.
   }
   VertexPtr high =
-      ConvertBdd(ite->high(), complement, bdd_graph, sublimit, ites);
-  VertexPtr low = ConvertBdd(ite->low(), ite->complement_edge() ^ complement,
+      ConvertBdd(ite.high(), complement, bdd_graph, sublimit, ites);
+  VertexPtr low = ConvertBdd(ite.low(), ite.complement_edge() ^ complement,
                              bdd_graph, sublimit, ites);
   return GetReducedVertex(ite, false, high,
                           GetReducedVertex(ite, true, low, consensus));
@@ -359,7 +1032,8 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   });
   auto it = args.cbegin();
   for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, kSettings_.limit_order());
+    result = Apply(gate.type(), result, *it, kSettings_.limit_order(),
+                   Zbdd::max_weight());
   }
   ClearTables();
   assert(result);
@@ -370,57 +1044,64 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   return result;
 }
 
-Triplet Zbdd::GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                           int order) noexcept {
+Quadruplet Zbdd::GetResultKey(const VertexPtr& arg_one,
+                              const VertexPtr& arg_two, int order,
+                              int weight) noexcept {
   assert(order >= 0 && "Illegal order for computations.");
+  assert(weight >= 0 && "Illegal weight for computations.");
   assert(!arg_one->terminal() && !arg_two->terminal());
   assert(arg_one->id() && arg_two->id());
   assert(arg_one->id() != arg_two->id());
   int min_id = std::min(arg_one->id(), arg_two->id());
   int max_id = std::max(arg_one->id(), arg_two->id());
-  return {min_id, max_id, order};
+  return {min_id, max_id, order, weight};
 }
 
 /// Forward declarations of interdependent Apply operation specializations.
 /// @{
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
-                                  const VertexPtr& arg_two,
-                                  int limit_order) noexcept;
+                                  const VertexPtr& arg_two, int limit_order,
+                                  int limit_weight) noexcept;
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
-                                 const VertexPtr& arg_two,
-                                 int limit_order) noexcept;
+                                 const VertexPtr& arg_two, int limit_order,
+                                 int limit_weight) noexcept;
 /// @}
 
 /// Specialization of Apply for AND operator for non-terminal ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const SetNodePtr& arg_one,
-                                  const SetNodePtr& arg_two,
-                                  int limit_order) noexcept {
+                                  const SetNodePtr& arg_two, int limit_order,
+                                  int limit_weight) noexcept {
   VertexPtr high;
   VertexPtr low;
   int limit_high = limit_order - !MayBeUnity(*arg_one);
+  int weight_high = limit_weight - Weight(*arg_one);
   if (arg_one->order() == arg_two->order() &&
       arg_one->index() == arg_two->index()) {  // The same variable.
     // (x*f1 + f0) * (x*g1 + g0) = x*(f1*(g1 + g0) + f0*g1) + f0*g0
     high = Apply<kOr>(
         Apply<kAnd>(arg_one->high(),
-                    Apply<kOr>(arg_two->high(), arg_two->low(), limit_high),
-                    limit_high),
-        Apply<kAnd>(arg_one->low(), arg_two->high(), limit_high), limit_high);
-    low = Apply<kAnd>(arg_one->low(), arg_two->low(), limit_order);
+                    Apply<kOr>(arg_two->high(), arg_two->low(), limit_high,
+                               weight_high),
+                    limit_high, weight_high),
+        Apply<kAnd>(arg_one->low(), arg_two->high(), limit_high, weight_high),
+        limit_high, weight_high);
+    low = Apply<kAnd>(arg_one->low(), arg_two->low(), limit_order,
+                      limit_weight);
   } else {
     assert((arg_one->order() < arg_two->order() ||
             arg_one->index() > arg_two->index()) &&
            "Ordering contract failed.");
     if (arg_one->order() == arg_two->order()) {
       // (x*f1 + f0) * (~x*g1 + g0) = x*f1*g0 + f0*(~x*g1 + g0)
-      high = Apply<kAnd>(arg_one->high(), arg_two->low(), limit_high);
+      high = Apply<kAnd>(arg_one->high(), arg_two->low(), limit_high,
+                         weight_high);
     } else {
-      high = Apply<kAnd>(arg_one->high(), arg_two, limit_high);
+      high = Apply<kAnd>(arg_one->high(), arg_two, limit_high, weight_high);
     }
-    low = Apply<kAnd>(arg_one->low(), arg_two, limit_order);
+    low = Apply<kAnd>(arg_one->low(), arg_two, limit_order, limit_weight);
   }
   if (!high->terminal() && SetNode::Ref(high).order() == arg_one->order()) {
     assert(SetNode::Ref(high).index() < arg_one->index());
@@ -432,25 +1113,27 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const SetNodePtr& arg_one,
 /// Specialization of Apply for AND operator for any ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
-                                  const VertexPtr& arg_two,
-                                  int limit_order) noexcept {
+                                  const VertexPtr& arg_two, int limit_order,
+                                  int limit_weight) noexcept {
   if (limit_order < 0)
     return kEmpty_;
   if (arg_one->terminal()) {
     if (Terminal<SetNode>::Ref(arg_one).value())
-      return Prune(arg_two, limit_order);
+      return Prune(arg_two, limit_order, limit_weight);
     return kEmpty_;
   }
   if (arg_two->terminal()) {
     if (Terminal<SetNode>::Ref(arg_two).value())
-      return Prune(arg_one, limit_order);
+      return Prune(arg_one, limit_order, limit_weight);
     return kEmpty_;
   }
   if (arg_one->id() == arg_two->id())
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, limit_weight);
+  if (limit_weight < 0)  // Cut-off on the product probability.
+    return Truncate(limit_weight);
 
-  VertexPtr& result =
-      and_table_[GetResultKey(arg_one, arg_two, limit_order)];
+  VertexPtr& result = and_table_[GetResultKey(arg_one, arg_two, limit_order,
+                                              limit_weight)];
   if (result)
     return result;  // Already computed.
 
@@ -462,7 +1145,7 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kAnd>(set_one, set_two, limit_order);
+  result = Apply<kAnd>(set_one, set_two, limit_order, limit_weight);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
   return result;
@@ -471,15 +1154,18 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
 /// Specialization of Apply for OR operator for non-terminal ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
-                                 const SetNodePtr& arg_two,
-                                 int limit_order) noexcept {
+                                 const SetNodePtr& arg_two, int limit_order,
+                                 int limit_weight) noexcept {
   VertexPtr high;
   VertexPtr low;
   int limit_high = limit_order - !MayBeUnity(*arg_one);
+  int weight_high = limit_weight - Weight(*arg_one);
   if (arg_one->order() == arg_two->order() &&
       arg_one->index() == arg_two->index()) {  // The same variable.
-    high = Apply<kOr>(arg_one->high(), arg_two->high(), limit_high);
-    low = Apply<kOr>(arg_one->low(), arg_two->low(), limit_order);
+    high = Apply<kOr>(arg_one->high(), arg_two->high(), limit_high,
+                      weight_high);
+    low = Apply<kOr>(arg_one->low(), arg_two->low(), limit_order,
+                     limit_weight);
   } else {
     assert((arg_one->order() < arg_two->order() ||
             arg_one->index() > arg_two->index()) &&
@@ -488,8 +1174,8 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
       if (arg_one->high()->terminal() && arg_two->high()->terminal())
         return kBase_;
     }
-    high = Prune(arg_one->high(), limit_high);
-    low = Apply<kOr>(arg_one->low(), arg_two, limit_order);
+    high = Prune(arg_one->high(), limit_high, weight_high);
+    low = Apply<kOr>(arg_one->low(), arg_two, limit_order, limit_weight);
   }
   if (!high->terminal() && SetNode::Ref(high).order() == arg_one->order()) {
     assert(SetNode::Ref(high).index() < arg_one->index());
@@ -501,25 +1187,27 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
 /// Specialization of Apply for OR operator for any ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
-                                 const VertexPtr& arg_two,
-                                 int limit_order) noexcept {
+                                 const VertexPtr& arg_two, int limit_order,
+                                 int limit_weight) noexcept {
   if (limit_order < 0)
     return kEmpty_;
   if (arg_one->terminal()) {
     if (Terminal<SetNode>::Ref(arg_one).value())
-      return kBase_;
-    return Prune(arg_two, limit_order);
+      return Prune(kBase_, limit_order, limit_weight);
+    return Prune(arg_two, limit_order, limit_weight);
   }
   if (arg_two->terminal()) {
     if (Terminal<SetNode>::Ref(arg_two).value())
-      return kBase_;
-    return Prune(arg_one, limit_order);
+      return Prune(kBase_, limit_order, limit_weight);
+    return Prune(arg_one, limit_order, limit_weight);
   }
   if (arg_one->id() == arg_two->id())
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, limit_weight);
+  if (limit_weight < 0)  // Cut-off on the product probability.
+    return Truncate(limit_weight);
 
-  VertexPtr& result =
-      or_table_[GetResultKey(arg_one, arg_two, limit_order)];
+  VertexPtr& result = or_table_[GetResultKey(arg_one, arg_two, limit_order,
+                                             limit_weight)];
   if (result)
     return result;  // Already computed.
 
@@ -531,19 +1219,19 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kOr>(set_one, set_two, limit_order);
+  result = Apply<kOr>(set_one, set_two, limit_order, limit_weight);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
   return result;
 }
 
 Zbdd::VertexPtr Zbdd::Apply(Operator type, const VertexPtr& arg_one,
-                            const VertexPtr& arg_two,
-                            int limit_order) noexcept {
+                            const VertexPtr& arg_two, int limit_order,
+                            int limit_weight) noexcept {
   if (type == kAnd)
-    return Apply<kAnd>(arg_one, arg_two, limit_order);
+    return Apply<kAnd>(arg_one, arg_two, limit_order, limit_weight);
   assert(type == kOr && "Only normalized operations in BDD.");
-  return Apply<kOr>(arg_one, arg_two, limit_order);
+  return Apply<kOr>(arg_one, arg_two, limit_order, limit_weight);
 }
 
 Zbdd::VertexPtr Zbdd::EliminateComplements(
@@ -571,7 +1259,8 @@ Zbdd::VertexPtr Zbdd::EliminateComplement(const SetNodePtr& node,
   assert(low->terminal() ||
          SetNode::Ref(low).max_set_order() <= kSettings_.limit_order());
   if (node->index() < 0 && !(node->module() && !node->coherent()))
-    return Apply<kOr>(high, low, kSettings_.limit_order());
+    return Apply<kOr>(high, low, kSettings_.limit_order(),
+                      Zbdd::max_weight());
   return Minimize(GetReducedVertex(node, high, low));
 }
 
@@ -609,7 +1298,8 @@ Zbdd::VertexPtr Zbdd::EliminateConstantModule(const SetNodePtr& node,
     if (module->root_->terminal()) {
       if (!Terminal<SetNode>::Ref(module->root_).value())
         return low;
-      return Apply<kOr>(high, low, kSettings_.limit_order());
+      return Apply<kOr>(high, low, kSettings_.limit_order(),
+                        Zbdd::max_weight());
     }
   }
   return Minimize(GetReducedVertex(node, high, low));
@@ -681,23 +1371,28 @@ Zbdd::VertexPtr Zbdd::Subsume(const VertexPtr& high,
   return computed;
 }
 
-Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order) noexcept {
-  if (limit_order < 0)
+Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order,
+                            int limit_weight) noexcept {
+  if (limit_order < 0 || vertex == kEmpty_)
     return kEmpty_;
+  if (limit_weight < 0)  // Cut-off on the product probability.
+    return Truncate(limit_weight);
   if (vertex->terminal())
     return vertex;
 
   SetNodePtr node = SetNode::Ptr(vertex);
-  if (node->max_set_order() <= limit_order)
+  if (node->max_set_order() <= limit_order && !cut_off_)
     return node;
 
-  VertexPtr& result = prune_results_[{node->id(), limit_order}];
+  VertexPtr& result =
+      prune_results_[{node->id(), limit_order, limit_weight}];
   if (result)
     return result;
 
   int limit_high = limit_order - !MayBeUnity(*node);
-  result = GetReducedVertex(node, Prune(node->high(), limit_high),
-                            Prune(node->low(), limit_order));
+  int weight_high = limit_weight - Weight(*node);
+  result = GetReducedVertex(node, Prune(node->high(), limit_high, weight_high),
+                            Prune(node->low(), limit_order, limit_weight));
   if (!result->terminal())
     SetNode::Ref(result).minimal(node->minimal());
   return result;
@@ -848,9 +1543,12 @@ void Zbdd::TestStructure(const VertexPtr& vertex, bool modules) noexcept {
 
 namespace zbdd {
 
-CutSetContainer::CutSetContainer(const Settings& settings, int module_index,
-                                 int gate_index_bound) noexcept
-    : Zbdd(settings, /*coherence=*/false, module_index),
+CutSetContainer::CutSetContainer(
+    const Settings& settings, int module_index, int gate_index_bound,
+    std::shared_ptr<const CutOff> cut_off,
+    std::shared_ptr<const ModuleCache> cache) noexcept
+    : Zbdd(settings, /*coherence=*/false, module_index, std::move(cut_off),
+           std::move(cache)),
       gate_index_bound_(gate_index_bound) {}
 
 Zbdd::VertexPtr CutSetContainer::ConvertGate(const Gate& gate) noexcept {
@@ -872,7 +1570,8 @@ Zbdd::VertexPtr CutSetContainer::ConvertGate(const Gate& gate) noexcept {
   auto it = args.cbegin();
   VertexPtr result = *it;
   for (++it; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, settings().limit_order());
+    result = Apply(gate.type(), result, *it, settings().limit_order(),
+                   Zbdd::max_weight());
   }
   ClearTables();
   return result;
@@ -898,13 +1597,15 @@ CutSetContainer::ExpandGate(const VertexPtr& gate_zbdd,
          SetNode::Ref(gate_zbdd).max_set_order() <= settings().limit_order());
   assert(cut_sets->terminal() ||
          SetNode::Ref(cut_sets).max_set_order() <= settings().limit_order());
-  return Apply<kAnd>(gate_zbdd, cut_sets, settings().limit_order());
+  return Apply<kAnd>(gate_zbdd, cut_sets, settings().limit_order(),
+                     Zbdd::max_weight());
 }
 
 void CutSetContainer::Merge(const VertexPtr& vertex) noexcept {
   assert(vertex->terminal() ||
          SetNode::Ref(vertex).max_set_order() <= settings().limit_order());
-  root(Apply<kOr>(root(), vertex, settings().limit_order()));
+  root(Apply<kOr>(root(), vertex, settings().limit_order(),
+                  Zbdd::max_weight()));
   ClearTables();
 }
 
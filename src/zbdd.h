@@ -21,11 +21,14 @@
 #ifndef SCRAM_SRC_ZBDD_H_
 #define SCRAM_SRC_ZBDD_H_
 
+#include <cmath>
 #include <cstdint>
 
 #include <array>
 #include <map>
 #include <memory>
+#include <numeric>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -127,6 +130,80 @@ struct TripletHash {
 template <typename Value>
 using TripletTable = std::unordered_map<Triplet, Value, TripletHash>;
 
+using Quadruplet = std::array<int, 4>;  ///< Quadruplet of numbers for functions.
+
+/// Functor for hashing quadruplets of ordered numbers.
+struct QuadrupletHash {
+  /// Operator overload for hashing four ordered numbers.
+  ///
+  /// @param[in] quadruplet  Four numbers.
+  ///
+  /// @returns Hash value of the quadruplet.
+  std::size_t operator()(const Quadruplet& quadruplet) const noexcept {
+    return boost::hash_range(quadruplet.begin(), quadruplet.end());
+  }
+};
+
+/// Hash table with quadruplets of numbers as keys.
+///
+/// @tparam Value  Type of values to be stored in the table.
+template <typename Value>
+using QuadrupletTable = std::unordered_map<Quadruplet, Value, QuadrupletHash>;
+
+/// Probability cut-off on products
+/// expressed with integer weights of literals.
+/// The weight of a literal is its negative binary logarithm of probability
+/// scaled and rounded down to an integer,
+/// so that the probability cut-off is applied to products
+/// in the same manner as the limit on the product order.
+///
+/// @note The rounding is conservative;
+///       that is, products with probabilities above the cut-off
+///       are never truncated.
+class CutOff {
+ public:
+  /// Creates the probability cut-off for products of a graph
+  /// if the analysis requests it.
+  ///
+  /// @param[in] graph  PDAG with the basic events of the variables.
+  /// @param[in] settings  Analysis settings with the cut-off.
+  ///
+  /// @returns The shared cut-off for ZBDD and its modules.
+  /// @returns nullptr if the cut-off is not applicable.
+  static std::shared_ptr<const CutOff> Create(const Pdag& graph,
+                                              const Settings& settings);
+
+  /// @param[in] graph  PDAG with the basic events of the variables.
+  /// @param[in] cut_off  The cut-off probability for products.
+  ///
+  /// @pre The basic events have probability expressions.
+  CutOff(const Pdag& graph, double cut_off) noexcept;
+
+  /// @returns The maximum weight of products above the cut-off.
+  int limit() const { return limit_; }
+
+  /// @param[in] index  Positive or negative index of a variable.
+  ///
+  /// @returns The weight of the variable literal.
+  int weight(int index) const {
+    return index > 0 ? weights_[index].first : weights_[-index].second;
+  }
+
+  /// @param[in] weight  The total weight of a product.
+  ///
+  /// @returns The upper bound on the probability of the product.
+  double p(int weight) const { return std::exp2(-weight / kScale); }
+
+ private:
+  static constexpr double kScale = 4;  ///< Weight units per binary order.
+
+  int limit_;  ///< The maximum weight of products.
+  /// The weights of positive and negative literals of variables.
+  Pdag::IndexMap<std::pair<int, int>> weights_;
+};
+
+class ModuleCache;
+
 /// Zero-Suppressed Binary Decision Diagrams for set manipulations.
 class Zbdd : private boost::noncopyable {
  public:
@@ -351,9 +428,12 @@ class Zbdd : private boost::noncopyable {
 
   /// @returns The number of *products* in the ZBDD.
   ///
-  /// @note This is not cheap.
-  ///       The complexity is O(N) on the number of *sets* in ZBDD.
-  std::size_t size() const { return std::distance(begin(), end()); }
+  /// @note The products are counted without enumeration (see Distribution).
+  std::size_t size() const {
+    std::vector<std::int64_t> distribution = Distribution();
+    return std::accumulate(distribution.begin(), distribution.end(),
+                           std::int64_t(0));
+  }
 
   /// @returns true for ZBDD with no products.
   bool empty() const { return begin() == end(); }
@@ -361,14 +441,92 @@ class Zbdd : private boost::noncopyable {
   /// @returns true if the ZBDD represents a base/unity set.
   bool base() const { return root_ == kBase_; }
 
+  /// Counts products by their sizes without enumerating the products.
+  /// The counts of set nodes are calculated with dynamic programming
+  /// over the flattened ZBDD and its modules.
+  /// The counts of modules are multiplied in
+  /// with the limit on the product order.
+  ///
+  /// @returns The number of products of each size starting with 0 (Base)
+  ///          up to the size of the largest product.
+  ///
+  /// @note The complexity is O(N * L) on the number of set nodes N
+  ///       and the limit order L (O(N * L^2) for module nodes).
+  std::vector<std::int64_t> Distribution() const noexcept;
+
+  /// Calculates the sum of the products of literal probabilities
+  /// without enumerating the products.
+  ///
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns The sum of the probabilities of products.
+  double CalculateProbabilitySum(const Pdag::IndexMap<double>& p_vars) const
+      noexcept;
+
+  /// Gathers the variables that appear in products
+  /// without enumerating the products.
+  ///
+  /// @returns Sorted unique positive indices of the variables in products.
+  std::vector<int> GatherVariables() const noexcept;
+
+  /// @returns The estimated probability mass of products
+  ///          truncated with the probability cut-off,
+  ///          i.e., the sum of upper bounds of discarded partial products.
+  double truncated_mass() const noexcept;
+
+  /// Set node flattened for calculations over the products
+  /// with dynamic programming instead of product enumeration.
+  /// The positions refer to preceding nodes in the topological order,
+  /// and negative positions denote the terminal sets.
+  struct FlatNode {
+    /// The index of the variable
+    /// or the position of the module root node.
+    int index;
+    int high;  ///< The position of the high node.
+    int low;  ///< The position of the low node.
+    bool module;  ///< Indication of a module node.
+  };
+
+  static const int kBasePosition = -1;  ///< The position of the Base set.
+  static const int kEmptyPosition = -2;  ///< The position of the Empty set.
+
+  /// Flattens the ZBDD and its modules
+  /// into the topologically sorted nodes (children first).
+  ///
+  /// @param[out] nodes  The destination container for flattened nodes.
+  ///
+  /// @returns The position of the root node.
+  int Flatten(std::vector<FlatNode>* nodes) const noexcept;
+
+  /// Extracts the most probable products
+  /// without enumerating all the products in the ZBDD.
+  /// The products are found with best-first search
+  /// over the flattened nodes of the ZBDD and its modules
+  /// annotated with the maximum product probability of each node.
+  ///
+  /// @param[in] num_products  The number of products to extract.
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns A new ZBDD container with only the most probable products
+  ///          (ties are broken arbitrarily).
+  ///
+  /// @pre The ZBDD is final, i.e., analyzed with its modules.
+  std::unique_ptr<Zbdd> TopProducts(int num_products,
+                                    const Pdag::IndexMap<double>& p_vars) const
+      noexcept;
+
  protected:
   /// The common constructor to initialize member variables.
   ///
   /// @param[in] settings  Settings that control analysis complexity.
   /// @param[in] coherent  A flag for coherent modular functions.
   /// @param[in] module_index  The index of a module if known.
+  /// @param[in] cut_off  The probability cut-off on products if any.
+  /// @param[in] cache  The persistent cache of module products if any.
   explicit Zbdd(const Settings& settings, bool coherent = false,
-                int module_index = 0) noexcept;
+                int module_index = 0,
+                std::shared_ptr<const CutOff> cut_off = nullptr,
+                std::shared_ptr<const ModuleCache> cache = nullptr) noexcept;
 
   /// @returns Current root vertex of the ZBDD.
   const VertexPtr& root() const { return root_; }
@@ -381,6 +539,20 @@ class Zbdd : private boost::noncopyable {
   /// @returns Analysis setting with this ZBDD.
   const Settings& settings() const { return kSettings_; }
 
+  /// @returns The limit on the weight of products for the probability cut-off.
+  int max_weight() const { return cut_off_ ? cut_off_->limit() : 0; }
+
+  /// Loads the final products of a module from the cache.
+  /// Otherwise, the module products are stored in the cache
+  /// upon the analysis.
+  ///
+  /// @param[in] gate  The root gate of the module.
+  ///
+  /// @returns true if the products are loaded, and the ZBDD is final.
+  ///
+  /// @pre The ZBDD is empty and represents the module gate.
+  bool LoadModule(const Gate& gate) noexcept;
+
   /// @returns A set of registered and fully processed modules;
   const std::map<int, std::unique_ptr<Zbdd>>& modules() const {
     return modules_;
@@ -429,13 +601,14 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument ZBDD set.
   /// @param[in] arg_two  Second argument ZBDD set.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight of products.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
-  /// @post The limit on the set order is guaranteed.
+  /// @post The limits on the set order and weight are guaranteed.
   template <Operator Type>
   VertexPtr Apply(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                  int limit_order) noexcept;
+                  int limit_order, int limit_weight) noexcept;
 
   /// Applies Boolean operation to two vertices representing sets.
   /// This is a convenience function
@@ -445,14 +618,16 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument ZBDD set.
   /// @param[in] arg_two  Second argument ZBDD set.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight of products.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @pre The operator is either AND or OR.
   ///
-  /// @post The limit on the set order is guaranteed.
+  /// @post The limits on the set order and weight are guaranteed.
   VertexPtr Apply(Operator type, const VertexPtr& arg_one,
-                  const VertexPtr& arg_two, int limit_order) noexcept;
+                  const VertexPtr& arg_two, int limit_order,
+                  int limit_weight) noexcept;
 
   /// Applies Boolean operation to ZBDD graph non-terminal vertices.
   ///
@@ -461,13 +636,14 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument set vertex.
   /// @param[in] arg_two  Second argument set vertex.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight of products.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @pre Argument vertices are ordered.
   template <Operator Type>
   VertexPtr Apply(const SetNodePtr& arg_one, const SetNodePtr& arg_two,
-                  int limit_order) noexcept;
+                  int limit_order, int limit_weight) noexcept;
 
   /// Removes complements of variables from products.
   /// This procedure only needs to be performed for non-coherent graphs
@@ -515,6 +691,30 @@ class Zbdd : private boost::noncopyable {
                     int current_order,
                     std::map<int, std::pair<bool, int>>* modules) noexcept;
 
+  /// Sums the weights of products by the product size
+  /// with dynamic programming over the flattened ZBDD.
+  /// The weight of a product is the product of its literal weights.
+  ///
+  /// @tparam F  Functor type (int index) -> double for literal weights.
+  ///
+  /// @param[in] weight  The weights of variable literals.
+  ///
+  /// @returns The sums of product weights for each product size
+  ///          starting with 0 (Base) up to the size of the largest product.
+  template <class F>
+  std::vector<double> SumProducts(F weight) const noexcept;
+
+  /// Flattens the ZBDD graph.
+  ///
+  /// @param[in] vertex  The root vertex of the (sub-)graph.
+  /// @param[in,out] nodes  The container of flattened nodes.
+  /// @param[in,out] positions  The positions of flattened set nodes.
+  ///
+  /// @returns The position of the flattened vertex.
+  int Flatten(const VertexPtr& vertex, std::vector<FlatNode>* nodes,
+              std::unordered_map<const SetNode*, int>* positions) const
+      noexcept;
+
   /// Clears all memoization tables.
   void ClearTables() noexcept {
     and_table_.clear();
@@ -559,7 +759,7 @@ class Zbdd : private boost::noncopyable {
 
  private:
   using SetNodeWeakPtr = WeakIntrusivePtr<SetNode>;  ///< Pointer for tables.
-  using ComputeTable = TripletTable<VertexPtr>;  ///< General computation table.
+  using ComputeTable = QuadrupletTable<VertexPtr>;  ///< Computation table.
   /// Module entry in the tables with its original gate index.
   using ModuleEntry = std::pair<const int, std::unique_ptr<Zbdd>>;
 
@@ -592,10 +792,28 @@ class Zbdd : private boost::noncopyable {
   ///
   /// @param[in] gate  The root gate of a module.
   /// @param[in] settings  Analysis settings.
+  /// @param[in] cut_off  The probability cut-off on products if any.
+  /// @param[in] cache  The persistent cache of module products if any.
   ///
   /// @post The root vertex pointer is uninitialized
   ///       if the PDAG is constant or single variable.
-  Zbdd(const Gate& gate, const Settings& settings) noexcept;
+  Zbdd(const Gate& gate, const Settings& settings,
+       std::shared_ptr<const CutOff> cut_off,
+       std::shared_ptr<const ModuleCache> cache) noexcept;
+
+  /// Restores the final ZBDD graph from flattened set nodes.
+  /// Modules are restored into new ZBDD containers
+  /// with proxy indices beyond the variable indices.
+  ///
+  /// @param[in] nodes  The flattened set nodes (see Flatten).
+  /// @param[in] position  The position of the flattened vertex.
+  /// @param[in] module_base  The base of the proxy indices for modules.
+  /// @param[in,out] vertices  The restored vertices by their positions.
+  ///
+  /// @returns The restored vertex.
+  VertexPtr Restore(const std::vector<FlatNode>& nodes, int position,
+                    int module_base,
+                    std::unordered_map<int, VertexPtr>* vertices) noexcept;
 
   /// Finds a replacement for an existing node
   /// or adds a new node based on an existing node.
@@ -619,7 +837,7 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] low  The low ZBDD vertex.
   ///
   /// @returns Resultant reduced vertex.
-  VertexPtr GetReducedVertex(const ItePtr& ite, bool complement,
+  VertexPtr GetReducedVertex(const Ite& ite, bool complement,
                              const VertexPtr& high,
                              const VertexPtr& low) noexcept;
 
@@ -641,15 +859,16 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument.
   /// @param[in] arg_two  Second argument.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] limit_weight  The limit on the weight of products.
   ///
-  /// @returns A triplet of integers for the computation key.
+  /// @returns A quadruplet of integers for the computation key.
   ///
   /// @pre The arguments are not the same functions.
   ///      Equal ID functions are handled by the reduction.
   /// @pre Even though the arguments are not SetNodePtr type,
   ///      they are ZBDD SetNode vertices.
-  Triplet GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                       int limit_order) noexcept;
+  Quadruplet GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
+                          int limit_order, int limit_weight) noexcept;
 
   /// Converts BDD graph into ZBDD graph.
   ///
@@ -662,15 +881,16 @@ class Zbdd : private boost::noncopyable {
   /// @returns Pointer to the root vertex of the ZBDD graph.
   ///
   /// @post The input BDD structure is not changed.
-  VertexPtr ConvertBdd(const Bdd::VertexPtr& vertex, bool complement,
-                       Bdd* bdd_graph, int limit_order,
-                       PairTable<VertexPtr>* ites) noexcept;
+  VertexPtr ConvertBdd(Bdd::Handle vertex, bool complement, Bdd* bdd_graph,
+                       int limit_order, PairTable<VertexPtr>* ites) noexcept;
 
   /// Converts BDD if-then-else vertex into ZBDD graph.
   /// This overload differs in that
   /// it does not register the results.
   /// It is used by the BDD vertex to ZBDD converter,
   /// and this function should not be called directly.
+  /// The BDD vertices are only read,
+  /// so that modules can be converted concurrently.
   ///
   /// @param[in] ite  ITE vertex of the ROBDD graph.
   /// @param[in] complement  Interpretation of the vertex as complement.
@@ -679,7 +899,7 @@ class Zbdd : private boost::noncopyable {
   /// @param[in,out] ites  Processed function graphs with ids and limit order.
   ///
   /// @returns Pointer to the root vertex of the ZBDD graph.
-  VertexPtr ConvertBdd(const ItePtr& ite, bool complement,
+  VertexPtr ConvertBdd(const Ite& ite, bool complement,
                        Bdd* bdd_graph, int limit_order,
                        PairTable<VertexPtr>* ites) noexcept;
 
@@ -694,10 +914,29 @@ class Zbdd : private boost::noncopyable {
   /// @param[in,out] ites  Processed function graphs with ids and limit order.
   ///
   /// @returns Pointer to the root vertex of the ZBDD graph.
-  VertexPtr ConvertBddPrimeImplicants(const ItePtr& ite, bool complement,
+  VertexPtr ConvertBddPrimeImplicants(Bdd::Handle ite, bool complement,
                                       Bdd* bdd_graph, int limit_order,
                                       PairTable<VertexPtr>* ites) noexcept;
 
+  /// Converts a collection of products into ZBDD.
+  /// The literals in products are ordered by their indices
+  /// with the order of the complement right after the variable.
+  ///
+  /// @param[in] first  The first product in the range.
+  /// @param[in] last  The end of the range.
+  /// @param[in] position  The position of the literals
+  ///                      after the common prefix of the products.
+  ///
+  /// @returns Pointer to the root vertex of the ZBDD graph.
+  ///
+  /// @pre The products in the range share the common prefix.
+  /// @pre The products are sorted by the orders of their literals
+  ///      and form a collection of minimal sets.
+  VertexPtr ConvertProducts(
+      std::vector<std::vector<int>>::const_iterator first,
+      std::vector<std::vector<int>>::const_iterator last,
+      int position) noexcept;
+
   /// Transforms a PDAG gate into a Zbdd set graph.
   ///
   /// @param[in] gate  The root gate of the PDAG.
@@ -766,12 +1005,34 @@ class Zbdd : private boost::noncopyable {
   ///
   /// @param[in] vertex  The root vertex of the ZBDD.
   /// @param[in] limit_order  The cut-off order for the sets.
+  /// @param[in] limit_weight  The cut-off weight for the sets.
   ///
   /// @returns The root vertex of the pruned ZBDD.
   ///
   /// @post If the ZBDD is minimal,
   ///       the resultant pruned ZBDD is minimal.
-  VertexPtr Prune(const VertexPtr& vertex, int limit_order) noexcept;
+  VertexPtr Prune(const VertexPtr& vertex, int limit_order,
+                  int limit_weight) noexcept;
+
+  /// Accounts for products truncated with the probability cut-off.
+  ///
+  /// @param[in] limit_weight  The negative weight limit at the truncation.
+  ///
+  /// @returns The terminal Empty set as the result of the truncation.
+  const TerminalPtr& Truncate(int limit_weight) noexcept {
+    assert(cut_off_ && limit_weight < 0);
+    truncated_mass_ += cut_off_->p(cut_off_->limit() - limit_weight);
+    return kEmpty_;
+  }
+
+  /// @param[in] node  A node in the ZBDD.
+  ///
+  /// @returns The weight of the node literal for the probability cut-off.
+  int Weight(const SetNode& node) noexcept {
+    if (!cut_off_ || MayBeUnity(node) || this->IsGate(node))
+      return 0;
+    return cut_off_->weight(node.index());
+  }
 
   /// Checks if a set node represents a gate.
   /// Apply operations and truncation operations
@@ -846,6 +1107,11 @@ class Zbdd : private boost::noncopyable {
   VertexPtr root_;  ///< The root vertex of ZBDD.
   bool coherent_;  ///< Inherited coherence from BDD.
   int module_index_;  ///< Identifier for a module if any.
+  std::shared_ptr<const CutOff> cut_off_;  ///< The probability cut-off.
+  std::shared_ptr<const ModuleCache> cache_;  ///< The cache of modules.
+  std::string cache_key_;  ///< The key of the module products in the cache.
+  bool final_;  ///< The products are analyzed or loaded from the cache.
+  double truncated_mass_;  ///< The estimate of truncated probability mass.
 
   /// Table of unique SetNodes denoting sets.
   /// The key consists of (index, id_high, id_low) triplet.
@@ -855,7 +1121,7 @@ class Zbdd : private boost::noncopyable {
   /// The argument sets are recorded with their IDs (not vertex indices).
   /// In order to keep only unique computations,
   /// the argument IDs must be ordered.
-  /// The key is {min_id, max_id, max_order}.
+  /// The key is {min_id, max_id, max_order, max_weight}.
   /// @{
   ComputeTable and_table_;
   ComputeTable or_table_;
@@ -866,12 +1132,89 @@ class Zbdd : private boost::noncopyable {
   /// The results of subsume operations over sets.
   PairTable<VertexPtr> subsume_table_;
   /// The results of pruning operations.
-  PairTable<VertexPtr> prune_results_;
+  TripletTable<VertexPtr> prune_results_;
 
   std::map<int, std::unique_ptr<Zbdd>> modules_;  ///< Module graphs.
   int set_id_;  ///< Identification assignment for new set graphs.
 };
 
+/// Persistent cache of the final products of modules in a directory.
+/// The cache entries are named by the structural hashes of module gates
+/// with the IDs of basic events in place of variable indices
+/// and the analysis settings that affect the products,
+/// so that unchanged modules of an edited model are not recalculated.
+///
+/// @note The entries are written into temporary files
+///       and renamed upon completion,
+///       so concurrent analyses can share the cache directory.
+class ModuleCache {
+ public:
+  /// Creates the cache for modules of a graph
+  /// if the analysis requests it.
+  ///
+  /// @param[in] graph  Preprocessed PDAG with modules.
+  /// @param[in] settings  Analysis settings with the cache directory.
+  ///
+  /// @returns The shared cache for ZBDD and its modules.
+  /// @returns nullptr if the cache is not requested or not accessible.
+  static std::shared_ptr<const ModuleCache> Create(const Pdag& graph,
+                                                   const Settings& settings);
+
+  /// Calculates the structural hashes of the graph gates.
+  ///
+  /// @param[in] graph  Preprocessed PDAG with modules.
+  /// @param[in] settings  Analysis settings with the cache directory.
+  ///
+  /// @pre The basic events have probability expressions
+  ///      if the probability cut-off is requested.
+  ModuleCache(const Pdag& graph, const Settings& settings) noexcept;
+
+  /// @param[in] gate  The root gate of a module.
+  /// @param[in] settings  The settings of the module analysis.
+  ///
+  /// @returns The unique name of the module products in the cache.
+  std::string Key(const Gate& gate, const Settings& settings) const noexcept;
+
+  /// Loads the products of a module from the cache.
+  ///
+  /// @param[in] key  The name of the module products.
+  /// @param[out] nodes  The flattened set nodes with the graph indices.
+  /// @param[out] root  The position of the root node.
+  /// @param[out] truncated_mass  The truncated probability mass of products.
+  ///
+  /// @returns false if the entry is missing or invalid for the graph.
+  bool Load(const std::string& key, std::vector<Zbdd::FlatNode>* nodes,
+            int* root, double* truncated_mass) const noexcept;
+
+  /// Stores the final products of a module in the cache.
+  ///
+  /// @param[in] key  The name of the module products.
+  /// @param[in] products  The final ZBDD of the module.
+  void Store(const std::string& key, const Zbdd& products) const noexcept;
+
+  /// @returns The lower bound for proxy indices of the restored modules.
+  int module_base() const {
+    return Pdag::kVariableStartIndex + graph_.basic_events().size();
+  }
+
+ private:
+  /// 128-bit hash of structures for cache keys.
+  using Hash = std::array<std::uint64_t, 2>;
+
+  /// Calculates the hash of a gate and its arguments.
+  ///
+  /// @param[in] gate  The gate in the graph.
+  /// @param[in] probabilities  The flag to include the event probabilities.
+  ///
+  /// @returns The structural hash of the gate.
+  Hash HashGate(const Gate& gate, bool probabilities) noexcept;
+
+  const Pdag& graph_;  ///< The graph with basic events of variables.
+  std::string directory_;  ///< The cache directory.
+  std::unordered_map<std::string, int> indices_;  ///< Variable indices by IDs.
+  std::unordered_map<int, Hash> hashes_;  ///< Gate hashes by indices.
+};
+
 namespace zbdd {
 
 /// Storage for generated cut sets in MOCUS.
@@ -885,6 +1228,8 @@ class CutSetContainer : public Zbdd {
   /// @param[in] settings  Settings that control analysis complexity.
   /// @param[in] module_index  The of a module if known.
   /// @param[in] gate_index_bound  The exclusive lower bound for gate indices.
+  /// @param[in] cut_off  The probability cut-off on cut sets if any.
+  /// @param[in] cache  The persistent cache of module cut sets if any.
   ///
   /// @pre No complements of gates.
   /// @pre Gates are indexed sequentially
@@ -892,7 +1237,9 @@ class CutSetContainer : public Zbdd {
   /// @pre Basic events are indexed sequentially
   ///      up to a number less than or equal to the given lower bound.
   CutSetContainer(const Settings& settings, int module_index,
-                  int gate_index_bound) noexcept;
+                  int gate_index_bound,
+                  std::shared_ptr<const CutOff> cut_off = nullptr,
+                  std::shared_ptr<const ModuleCache> cache = nullptr) noexcept;
 
   /// Converts a PDAG gate into intermediate cut sets.
   ///
@@ -980,6 +1327,7 @@ class CutSetContainer : public Zbdd {
     return modules;
   }
 
+  using Zbdd::LoadModule;  ///< Loads the final cut sets from the cache.
   using Zbdd::JoinModule;  ///< Joins fully processed modules.
   using Zbdd::Log;  ///< Logs properties of the container.
 
@@ -15,9 +15,17 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <ctime>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <utility>
+
 #include <gtest/gtest.h>
 
 #include "risk_analysis_tests.h"
+#include "utility.h"
 
 namespace scram {
 namespace core {
@@ -37,6 +45,111 @@ TEST_P(RiskAnalysisTest, 200Event) {
   EXPECT_EQ(287, products().size());
 }
 
+// The products of nested modules are reused from the cache directory.
+TEST_P(RiskAnalysisTest, 200EventModuleCache) {
+  if (settings.algorithm() == Algorithm::kBdd)
+    return;  // Only ZBDD and MOCUS cache their modules.
+  std::string tree_input = "./share/scram/input/Autogenerated/200_event.xml";
+  fs::path cache = utility::GenerateFilePath();
+  // The entries are dated back to tell the reused ones from the stored.
+  const std::time_t kPast = 1000000000;
+  using Entries = std::map<std::string, std::pair<std::uintmax_t, bool>>;
+  auto entries = [&cache, kPast] {
+    Entries result;  // {size, reused} by name.
+    for (const fs::directory_entry& entry : fs::directory_iterator(cache)) {
+      result.emplace(entry.path().filename().string(),
+                     std::make_pair(fs::file_size(entry.path()),
+                                    fs::last_write_time(entry.path()) ==
+                                        kPast));
+    }
+    return result;
+  };
+  auto date_back = [&cache, kPast] {
+    for (const fs::directory_entry& entry : fs::directory_iterator(cache))
+      fs::last_write_time(entry.path(), kPast);
+  };
+  auto analyze = [this](const std::string& input, bool cached) {
+    Settings cache_settings(settings);
+    if (!cached)
+      settings.cache_directory("");
+    ProcessInputFiles({input});
+    analysis->Analyze();
+    settings = cache_settings;
+    return products();
+  };
+
+  settings.limit_order(15).cache_directory(cache.string());
+  std::set<std::set<std::string>> cold = analyze(tree_input, true);
+  EXPECT_EQ(287, cold.size());
+  Entries cold_entries = entries();
+  EXPECT_LT(2, cold_entries.size()) << "No nested modules in the cache.";
+  date_back();
+  EXPECT_EQ(cold, analyze(tree_input, true));
+  Entries warm_entries = entries();
+  EXPECT_EQ(cold_entries.size(), warm_entries.size());
+  for (const auto& entry : warm_entries)
+    EXPECT_TRUE(entry.second.second) << "Missed " << entry.first;
+
+  // The truncated and corrupted entries are recalculated.
+  int num_damaged = 0;
+  for (const auto& entry : cold_entries) {
+    fs::path file = cache / entry.first;
+    if (num_damaged++ % 2) {
+      fs::resize_file(file, entry.second.first / 2);
+    } else {
+      std::fstream stream(file.string(),
+                          std::ios::binary | std::ios::in | std::ios::out);
+      stream.seekp(entry.second.first / 2);
+      stream.put('\xff').put('\x7f').put('\xff').put('\x7f');
+    }
+  }
+  EXPECT_EQ(cold, analyze(tree_input, true));
+  // The variable ordering may differ from the cold run,
+  // so the stored entries are checked by reuse rather than by size.
+  date_back();
+  EXPECT_EQ(cold, analyze(tree_input, true));
+  Entries repaired_entries = entries();
+  EXPECT_EQ(cold_entries.size(), repaired_entries.size());
+  for (const auto& entry : repaired_entries)
+    EXPECT_TRUE(entry.second.second) << "Missed " << entry.first;
+
+  // The changed settings miss the entries of the original settings.
+  date_back();
+  for (int limit_order : {4, 8}) {
+    settings.limit_order(limit_order);
+    EXPECT_EQ(analyze(tree_input, false), analyze(tree_input, true))
+        << limit_order;
+  }
+  settings.limit_order(15).probability_analysis(true).cut_off(1e-6);
+  EXPECT_EQ(analyze(tree_input, false), analyze(tree_input, true));
+  settings.probability_analysis(false).cut_off(0);
+  Entries changed_entries = entries();
+  EXPECT_LT(cold_entries.size(), changed_entries.size());
+
+  // The edited modules of the model miss the entries.
+  std::ifstream original(tree_input);
+  std::string model((std::istreambuf_iterator<char>(original)),
+                    std::istreambuf_iterator<char>());
+  const std::string kEdit = "        <basic-event name=\"P3\"/>\n";
+  std::string::size_type edit = model.find(kEdit, model.find("\"E2\""));
+  ASSERT_NE(std::string::npos, edit);
+  model.erase(edit, kEdit.size());
+  fs::path edited_input = utility::GenerateFilePath() += ".xml";
+  std::ofstream(edited_input.string()) << model;
+  std::set<std::set<std::string>> edited =
+      analyze(edited_input.string(), false);
+  EXPECT_NE(cold, edited);
+  date_back();
+  EXPECT_EQ(edited, analyze(edited_input.string(), true));
+  Entries edited_entries = entries();
+  EXPECT_LT(changed_entries.size(), edited_entries.size());
+  for (const auto& entry : cold_entries)
+    EXPECT_TRUE(edited_entries.at(entry.first).second) << entry.first;
+
+  fs::remove(edited_input);
+  fs::remove_all(cache);
+}
+
 }  // namespace test
 }  // namespace core
 }  // namespace scram
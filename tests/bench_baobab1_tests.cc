@@ -77,6 +77,81 @@ TEST_P(RiskAnalysisTest, Baobab1L4Importance) {
       analysis->results().front().importance_analysis->importance().size());
 }
 
+TEST_P(RiskAnalysisTest, Baobab1CutOff) {
+  std::vector<std::string> input_files = {
+      "./share/scram/input/Baobab/baobab1.xml",
+      "./share/scram/input/Baobab/baobab1-basic-events.xml"};
+  settings.probability_analysis(true).cut_off(1e-9);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  int num_above_cut_off = 0;  // Products that must survive the truncation.
+  for (const auto& product : product_probability())
+    num_above_cut_off += product.second >= 1e-9;
+  EXPECT_EQ(256, num_above_cut_off);
+  if (settings.algorithm() != Algorithm::kBdd) {
+    EXPECT_EQ(532, products().size());
+    EXPECT_FALSE(
+        analysis->results().front().fault_tree_analysis->warnings().empty());
+  }
+}
+
+// The products of modules are counted and summed without enumeration.
+TEST_P(RiskAnalysisTest, Baobab1ProductSummaries) {
+  std::vector<std::string> input_files = {
+      "./share/scram/input/Baobab/baobab1.xml",
+      "./share/scram/input/Baobab/baobab1-basic-events.xml"};
+  settings.probability_analysis(true);
+  for (int limit_order : {2, 4, 6, 20}) {
+    settings.limit_order(limit_order);
+    ASSERT_NO_THROW(ProcessInputFiles(input_files));
+    ASSERT_NO_THROW(analysis->Analyze());
+    SCOPED_TRACE(limit_order);
+    CheckProductSummaries();
+  }
+}
+
+// The most probable products of modules with and without order limits.
+TEST_P(RiskAnalysisTest, Baobab1TopProducts) {
+  std::vector<std::string> input_files = {
+      "./share/scram/input/Baobab/baobab1.xml",
+      "./share/scram/input/Baobab/baobab1-basic-events.xml"};
+  for (int limit_order : {4, 6}) {
+    SCOPED_TRACE(limit_order);
+    settings.limit_order(limit_order);
+    CheckTopProducts(input_files, {1, 10, 1000});
+  }
+}
+
+TEST_F(RiskAnalysisTest, Baobab1Reorder) {
+  std::vector<std::string> input_files = {
+      "./share/scram/input/Baobab/baobab1.xml",
+      "./share/scram/input/Baobab/baobab1-basic-events.xml"};
+  settings.algorithm("bdd");
+  settings.probability_analysis(true).reorder(true);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(1.2823e-6, p_total(), 1e-8);
+  EXPECT_EQ(46188, products().size());
+  std::vector<int> distr = {0,     1,    1,     70,   400, 2212,
+                            14748, 8460, 10624, 6600, 3072};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
+TEST_F(RiskAnalysisTest, Baobab1ParallelApply) {
+  std::vector<std::string> input_files = {
+      "./share/scram/input/Baobab/baobab1.xml",
+      "./share/scram/input/Baobab/baobab1-basic-events.xml"};
+  settings.algorithm("bdd");
+  settings.probability_analysis(true).num_threads(4).bdd_fork_depth(6);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(1.2823e-6, p_total(), 1e-8);
+  EXPECT_EQ(46188, products().size());
+  std::vector<int> distr = {0,     1,    1,     70,   400, 2212,
+                            14748, 8460, 10624, 6600, 3072};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
 }  // namespace test
 }  // namespace core
 }  // namespace scram
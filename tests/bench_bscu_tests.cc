@@ -28,7 +28,7 @@ namespace test {
 TEST_P(RiskAnalysisTest, BSCU) {
   std::string tree_input = "./share/scram/input/BSCU/BSCU.xml";
   settings.uncertainty_analysis(true);
-  settings.num_trials(10000);
+  settings.num_trials(50000);
   ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
   ASSERT_NO_THROW(analysis->Analyze());
   std::set<std::set<std::string>> mcs = {
@@ -57,6 +57,28 @@ TEST_P(RiskAnalysisTest, BSCU) {
   }
 }
 
+// Multi-threaded uncertainty analysis must be reproducible
+// regardless of the number of threads.
+TEST_P(RiskAnalysisTest, BSCUThreads) {
+  std::string tree_input = "./share/scram/input/BSCU/BSCU.xml";
+  settings.uncertainty_analysis(true).num_trials(10000).num_threads(4);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  double first_mean = mean();
+  double first_sigma = sigma();
+  if (settings.approximation() == Approximation::kRareEvent) {
+    EXPECT_NEAR(0.137, first_mean, 1e-2);
+    EXPECT_NEAR(0.217, first_sigma, 1e-2);
+  } else {
+    EXPECT_NEAR(0.117, first_mean, 1e-2);
+    EXPECT_NEAR(0.183, first_sigma, 1e-2);
+  }
+  settings.num_threads(1);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(first_mean, mean());
+  EXPECT_EQ(first_sigma, sigma());
+}
 
 }  // namespace test
 }  // namespace core
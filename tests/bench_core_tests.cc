@@ -98,6 +98,20 @@ TEST_P(RiskAnalysisTest, Vote) {
   EXPECT_EQ(mcs, products());
 }
 
+// K/N gate with many arguments (6/12) and equal probabilities 0.1.
+TEST_P(RiskAnalysisTest, VoteLarge) {
+  std::string tree_input = "./share/scram/input/core/atleast_large.xml";
+  settings.probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  if (settings.approximation() == Approximation::kRareEvent) {
+    EXPECT_NEAR(924e-6, p_total(), 1e-12);
+  } else {
+    EXPECT_NEAR(5.412318222e-4, p_total(), 1e-12);
+  }
+  EXPECT_EQ(924, products().size());
+}
+
 // Benchmark tests for NOT gate.
 // [A OR NOT A]
 // This produces UNITY top gate.
@@ -200,6 +214,76 @@ TEST_F(RiskAnalysisTest, MonteCarloAorNotB) {
   ASSERT_NO_THROW(analysis->Analyze());
 }
 
+// The products with negative literals are counted and summed
+// without enumeration.
+TEST_P(RiskAnalysisTest, ProductSummaries) {
+  const char* models[] = {"ab_or_not_ac.xml", "a_or_not_ab.xml",
+                          "a_and_not_b.xml", "atleast.xml", "unity.xml",
+                          "null.xml"};
+  settings.probability_analysis(true);
+  for (const char* model : models) {
+    std::string tree_input = std::string("./share/scram/input/core/") + model;
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input})) << model;
+    ASSERT_NO_THROW(analysis->Analyze()) << model;
+    SCOPED_TRACE(model);
+    CheckProductSummaries();
+  }
+}
+
+// The most probable products with negative literals.
+TEST_P(RiskAnalysisTest, TopProducts) {
+  const char* models[] = {"ab_or_not_ac.xml", "a_or_not_ab.xml",
+                          "a_and_not_b.xml", "atleast.xml", "xor.xml"};
+  for (const char* model : models) {
+    std::string tree_input = std::string("./share/scram/input/core/") + model;
+    SCOPED_TRACE(model);
+    CheckTopProducts({tree_input}, {1, 2, 3});
+  }
+}
+
+// The simulation estimates against the exact BDD probabilities.
+TEST_F(RiskAnalysisTest, MonteCarloConfidenceInterval) {
+  const char* models[] = {"ab_bc.xml",   "abc.xml",         "atleast.xml",
+                          "xor.xml",     "a_or_not_b.xml",  "a_and_not_b.xml",
+                          "nand.xml",    "a_or_not_ab.xml", "nor.xml"};
+  for (const char* model : models) {
+    std::string tree_input = std::string("./share/scram/input/core/") + model;
+    settings.monte_carlo(0).algorithm("bdd").probability_analysis(true);
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input})) << model;
+    ASSERT_NO_THROW(analysis->Analyze()) << model;
+    double p_exact = p_total();
+
+    settings.monte_carlo(1e5);
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input})) << model;
+    ASSERT_NO_THROW(analysis->Analyze()) << model;
+    EXPECT_LE(confidence_interval().first, p_total()) << model;
+    EXPECT_GE(confidence_interval().second, p_total()) << model;
+    EXPECT_LE(confidence_interval().first, p_exact) << model;
+    EXPECT_GE(confidence_interval().second, p_exact) << model;
+  }
+}
+
+// The simulation results do not depend on the number of threads.
+TEST_F(RiskAnalysisTest, MonteCarloThreadIndependence) {
+  std::string tree_input = "./share/scram/input/core/single_exponential.xml";
+  settings.monte_carlo(2e5).time_step(24).mission_time(120);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  double p_single = p_total();
+  std::vector<std::pair<double, double>> curve_single =
+      analysis->results().front().probability_analysis->p_time();
+  EXPECT_GT(p_single, 0);
+  ASSERT_EQ(6, curve_single.size());
+  EXPECT_EQ(p_single, curve_single.back().first);
+
+  settings.num_threads(4);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(p_single, p_total());
+  EXPECT_EQ(curve_single,
+            analysis->results().front().probability_analysis->p_time());
+}
+
 // Repeated negative gate expansion.
 TEST_P(RiskAnalysisTest, MultipleParentNegativeGate) {
   std::string tree_input = "./share/scram/input/core/"
@@ -57,6 +57,9 @@ TEST(ConfigTest, FullSettings) {
   // Check the output destination.
   EXPECT_EQ(Env::install_dir() + "/share/scram/input/fta/./temp_results.xml",
             config.output_path());
+  // Check the module cache directory.
+  EXPECT_EQ(Env::install_dir() + "/share/scram/input/fta/./module_cache",
+            config.settings().cache_directory());
 
   const core::Settings& settings = config.settings();
   EXPECT_EQ(core::Algorithm::kBdd, settings.algorithm());
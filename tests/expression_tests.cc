@@ -16,6 +16,7 @@
  */
 
 #include "expression.h"
+#include "expression_tape.h"
 #include "expression/boolean.h"
 #include "expression/conditional.h"
 #include "expression/exponential.h"
@@ -167,6 +168,59 @@ TEST(ExpressionTest, Exponential) {
   ASSERT_FALSE(dev->IsDeviate());
 }
 
+TEST(ExpressionTest, ExpressionTape) {
+  OpenExpression lambda(0.1, 0.2, 0.05, 0.3);  // Deviate.
+  OpenExpression factor(2, 2);
+  MissionTime time(10);
+  Parameter param("param");
+  param.expression(&time);
+  Exponential exponential(&lambda, &param);
+  Mul mul({&exponential, &factor, &exponential});
+  Neg neg(&time);
+  std::vector<Expression*> expressions = {&mul, &neg, &factor};
+
+  ExpressionTape tape(expressions);
+  EXPECT_EQ(3, tape.size());
+  EXPECT_EQ(4, tape.num_instructions());  // The parameter is an alias.
+  double values[3] = {};
+  time.value(20);
+  tape.Evaluate(values);
+  EXPECT_DOUBLE_EQ(mul.value(), values[0]);
+  EXPECT_DOUBLE_EQ(-20, values[1]);
+  EXPECT_DOUBLE_EQ(2, values[2]);
+
+  ExpressionTape sample_tape(expressions, /*sample=*/true);
+  EXPECT_EQ(3, sample_tape.num_instructions());
+  sample_tape.Evaluate(values);
+  double p = 1 - std::exp(-0.2 * 20);
+  EXPECT_DOUBLE_EQ(p * 2 * p, values[0]);
+  EXPECT_DOUBLE_EQ(-20, values[1]);
+  EXPECT_DOUBLE_EQ(2, values[2]);
+}
+
+TEST(ExpressionTest, ExpressionTapeBatch) {
+  OpenExpression zero(0, 0);
+  OpenExpression two(2, 2);
+  OpenExpression sigma(1, 1);
+  NormalDeviate deviate(&zero, &sigma);
+  Mul mul({&deviate, &two});
+  Max max({&deviate, &zero});  // Sampled with the deviate samples.
+  Sub sub({&max, &deviate});
+
+  ExpressionTape tape({&mul, &max, &sub}, /*sample=*/true);
+  EXPECT_EQ(4, tape.num_instructions());
+  const int kNumTrials = 5;
+  double values[3 * kNumTrials] = {};
+  tape.Evaluate(values, kNumTrials);
+  for (int i = 0; i < kNumTrials; ++i) {
+    double sample = values[i] / 2;
+    EXPECT_DOUBLE_EQ(std::max(sample, 0.0), values[kNumTrials + i]);
+    EXPECT_DOUBLE_EQ(std::max(sample, 0.0) - sample,
+                     values[2 * kNumTrials + i]);
+  }
+  EXPECT_NE(values[0], values[1]);  // Independent trials.
+}
+
 TEST(ExpressionTest, GLM) {
   OpenExpression gamma(0.10, 0.8);
   OpenExpression lambda(10, 8);
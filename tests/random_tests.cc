@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "random.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace scram {
+namespace test {
+
+// The known answer for the zero key and counter
+// is from the Random123 reference implementation.
+TEST(RandomTest, Philox) {
+  Philox rng;
+  rng.seek(0, 0);
+  EXPECT_EQ(0x6627e8d5u, rng());
+  EXPECT_EQ(0xe169c58du, rng());
+  EXPECT_EQ(0xbc57ac4cu, rng());
+  EXPECT_EQ(0x9b00dbd8u, rng());
+
+  rng.seek(0xa4093822299f31d0u, 0x082efa98ec4e6c89u);
+  std::vector<Philox::result_type> block = {rng(), rng(), rng(), rng()};
+  Philox other;
+  other.seek(0xa4093822299f31d0u, 0x082efa98ec4e6c89u);
+  for (Philox::result_type value : block)
+    EXPECT_EQ(value, other());
+  EXPECT_EQ(rng(), other());  // The next block.
+  other.seek(0xa4093822299f31d0u, 0x082efa98ec4e6c8au);
+  EXPECT_NE(block.front(), other());
+}
+
+TEST(RandomTest, StreamReproducibility) {
+  Random::seed(42);
+  Random::stream(3, 7);
+  std::vector<double> first;
+  for (int i = 0; i < 10; ++i)
+    first.push_back(Random::UniformRealGenerator(0, 1));
+  Random::stream(3, 8);
+  double other_trial = Random::UniformRealGenerator(0, 1);
+  Random::stream(4, 7);
+  double other_target = Random::UniformRealGenerator(0, 1);
+  EXPECT_NE(first.front(), other_trial);
+  EXPECT_NE(first.front(), other_target);
+  EXPECT_EQ(4, Random::target());
+
+  Random::stream(3, 7);  // Regenerate the trial on its own.
+  for (double value : first)
+    EXPECT_EQ(value, Random::UniformRealGenerator(0, 1));
+  Random::seed(0);
+}
+
+TEST(RandomTest, BatchGenerators) {
+  Random::stream(1, 0);
+  const int kNumValues = 100001;  // Odd for the unpaired normal value.
+  std::vector<double> values(kNumValues);
+  auto mean = [&values] {
+    return std::accumulate(values.begin(), values.end(), 0.0) / kNumValues;
+  };
+  auto variance = [&values, &mean] {
+    double m = mean();
+    double sum = 0;
+    for (double value : values)
+      sum += (value - m) * (value - m);
+    return sum / (kNumValues - 1);
+  };
+
+  Random::UniformRealGenerator(2, 4, kNumValues, values.data());
+  EXPECT_LE(2, *std::min_element(values.begin(), values.end()));
+  EXPECT_GT(4, *std::max_element(values.begin(), values.end()));
+  EXPECT_NEAR(3, mean(), 0.01);
+
+  Random::NormalGenerator(1, 2, kNumValues, values.data());
+  EXPECT_NEAR(1, mean(), 0.02);
+  EXPECT_NEAR(4, variance(), 0.05);
+  EXPECT_NE(values[kNumValues - 2], values[kNumValues - 1]);
+
+  Random::LognormalGenerator(0, 0.5, kNumValues, values.data());
+  EXPECT_NEAR(std::exp(0.125), mean(), 0.01);
+
+  Random::GammaGenerator(2, 3, kNumValues, values.data());
+  EXPECT_NEAR(6, mean(), 0.05);
+  EXPECT_NEAR(18, variance(), 0.5);
+
+  Random::BetaGenerator(2, 6, kNumValues, values.data());
+  EXPECT_NEAR(0.25, mean(), 0.005);
+
+  std::vector<double> boundaries = {0, 1, 3};
+  std::vector<double> weights = {1, 3};
+  Random::HistogramGenerator(boundaries.begin(), boundaries.end(),
+                             weights.begin(), kNumValues, values.data());
+  EXPECT_NEAR(1.625, mean(), 0.01);
+  Random::seed(0);
+}
+
+}  // namespace test
+}  // namespace scram
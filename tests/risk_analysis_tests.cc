@@ -17,6 +17,9 @@
 
 #include "risk_analysis_tests.h"
 
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
 #include <utility>
 
 #include "utility.h"
@@ -80,10 +83,12 @@ const std::set<std::set<std::string>>& RiskAnalysisTest::products() {
 
 std::vector<int> RiskAnalysisTest::ProductDistribution() {
   assert(analysis->results().size() == 1);
-  return analysis->results()
-      .front()
-      .fault_tree_analysis->products()
-      .Distribution();
+  const std::vector<std::int64_t>& distribution = analysis->results()
+                                                      .front()
+                                                      .fault_tree_analysis
+                                                      ->products()
+                                                      .Distribution();
+  return {distribution.begin(), distribution.end()};
 }
 
 void RiskAnalysisTest::PrintProducts() {
@@ -91,6 +96,68 @@ void RiskAnalysisTest::PrintProducts() {
   Print(analysis->results().front().fault_tree_analysis->products());
 }
 
+void RiskAnalysisTest::CheckProductSummaries() {
+  assert(analysis->results().size() == 1);
+  const ProductContainer& container =
+      analysis->results().front().fault_tree_analysis->products();
+  std::int64_t size = 0;
+  std::vector<std::int64_t> distribution;
+  std::unordered_set<const mef::BasicEvent*> events;
+  double p_sum = 0;
+  for (const Product& product : container) {
+    ++size;
+    if (distribution.size() < product.order())
+      distribution.resize(product.order());
+    ++distribution[product.order() - 1];
+    for (const Literal& literal : product)
+      events.insert(&literal.event);
+    if (settings.probability_analysis())
+      p_sum += product.p();
+  }
+  EXPECT_EQ(size, container.size());
+  EXPECT_EQ(size == 0, container.empty());
+  EXPECT_EQ(distribution, container.Distribution());
+  EXPECT_EQ(events, container.product_events());
+  if (settings.probability_analysis())
+    EXPECT_NEAR(p_sum, container.p_sum(), 1e-12 * p_sum);
+}
+
+void RiskAnalysisTest::CheckTopProducts(
+    const std::vector<std::string>& input_files,
+    const std::vector<int>& nums_top) {
+  settings.top_products(0).probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  std::map<std::set<std::string>, double> all = product_probability();
+  std::vector<double> p_all;
+  for (const auto& product : all)
+    p_all.push_back(product.second);
+  std::sort(p_all.begin(), p_all.end(), std::greater<>());
+  double p_sum =
+      analysis->results().front().fault_tree_analysis->products().p_sum();
+
+  for (int num_top : nums_top) {
+    SCOPED_TRACE(num_top);
+    settings.top_products(num_top);
+    ASSERT_NO_THROW(ProcessInputFiles(input_files));
+    ASSERT_NO_THROW(analysis->Analyze());
+    const ProductContainer& top =
+        analysis->results().front().fault_tree_analysis->products();
+    EXPECT_EQ(std::min<std::int64_t>(num_top, all.size()), top.size());
+    EXPECT_EQ(all.size(), top.total_size());
+    EXPECT_NEAR(p_sum, top.p_sum(), 1e-12 * p_sum);
+    std::vector<double> p_top;
+    for (const auto& product : product_probability()) {
+      EXPECT_EQ(1, all.count(product.first));
+      p_top.push_back(product.second);
+    }
+    std::sort(p_top.begin(), p_top.end(), std::greater<>());
+    ASSERT_LE(p_top.size(), p_all.size());
+    for (int i = 0; i < p_top.size(); ++i)
+      EXPECT_NEAR(p_all[i], p_top[i], 1e-12 * p_all[i]) << i;
+  }
+}
+
 const std::map<std::set<std::string>, double>&
 RiskAnalysisTest::product_probability() {
   assert(analysis->results().size() == 1);
@@ -347,6 +414,30 @@ TEST_F(RiskAnalysisTest, McubNonCoherent) {
   EXPECT_NEAR(0.10, p_total(), 1e-5);
 }
 
+// The approximations calculated over the ZBDD graph with modules
+// must agree with the enumeration of products.
+TEST_P(RiskAnalysisTest, ApproximationsWithModules) {
+  if (settings.prime_implicants())
+    return;  // Prime implicants require no approximation.
+  std::string tree_input = "./share/scram/input/BSCU/BSCU.xml";
+  for (const char* approximation : {"rare-event", "mcub"}) {
+    settings.approximation(approximation).probability_analysis(true);
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+    ASSERT_NO_THROW(analysis->Analyze());
+    double sum = 0;
+    double m = 1;
+    for (const Product& product :
+         analysis->results().front().fault_tree_analysis->products()) {
+      sum += product.p();
+      m *= 1 - product.p();
+    }
+    double expected = settings.approximation() == Approximation::kRareEvent
+                          ? sum
+                          : 1 - m;
+    EXPECT_NEAR(expected, p_total(), 1e-12) << approximation;
+  }
+}
+
 // Test Monte Carlo Analysis
 /// @todo Expand this test.
 TEST_P(RiskAnalysisTest, AnalyzeMC) {
@@ -411,6 +502,19 @@ TEST_P(RiskAnalysisTest, AnalyzeSil) {
   compare_fractions(pfh_fractions, prob_an.sil().pfh_fractions, "PFH");
 }
 
+TEST_P(RiskAnalysisTest, AnalyzeSilAdaptiveTimeSteps) {
+  std::string tree_input = "./share/scram/input/core/single_exponential.xml";
+  settings.time_step(1000).time_tolerance(1e-4).safety_integrity_levels(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  ASSERT_FALSE(analysis->results().empty());
+  ASSERT_TRUE(analysis->results().front().probability_analysis);
+  const auto& prob_an = *analysis->results().front().probability_analysis;
+  EXPECT_NEAR(0.04255, prob_an.sil().pfd_avg, 0.00001);
+  EXPECT_NEAR(9.78e-6, prob_an.sil().pfh_avg, 1e-8);
+  EXPECT_LT(prob_an.p_time().size(), 8760 / 24);
+}
+
 TEST_P(RiskAnalysisTest, AnalyzeEventTree) {
   const char* tree_input = "./share/scram/input/EventTrees/bcd.xml";
   settings.probability_analysis(true);
@@ -21,11 +21,14 @@
 #include "risk_analysis.h"
 
 #include <set>
+#include <utility>
 #include <vector>
 
 #include <boost/range/algorithm.hpp>
 #include <gtest/gtest.h>
 
+#include "monte_carlo.h"
+
 namespace scram {
 namespace core {
 namespace test {
@@ -72,12 +75,34 @@ class RiskAnalysisTest : public ::testing::TestWithParam<const char*> {
   /// Prints products to the standard error.
   void PrintProducts();
 
+  /// Compares the product counts, events, and probability sum
+  /// calculated without enumeration
+  /// against the enumerated products.
+  void CheckProductSummaries();
+
+  /// Compares the most probable products
+  /// against the sorted list of all the products.
+  ///
+  /// @param[in] input_files  The model input files.
+  /// @param[in] nums_top  The numbers of top products to extract.
+  void CheckTopProducts(const std::vector<std::string>& input_files,
+                        const std::vector<int>& nums_top);
+
   double p_total() {
     assert(analysis->results().size() == 1);
     assert(analysis->results().front().probability_analysis);
     return analysis->results().front().probability_analysis->p_total();
   }
 
+  /// @returns The confidence interval of the Monte Carlo estimate.
+  const std::pair<double, double>& confidence_interval() {
+    assert(analysis->results().size() == 1);
+    auto* simulation = dynamic_cast<const MonteCarloAnalyzer*>(
+        analysis->results().front().probability_analysis.get());
+    assert(simulation);
+    return simulation->confidence_interval();
+  }
+
   /// @returns Products and their probabilities.
   const std::map<std::set<std::string>, double>& product_probability();
 
@@ -45,6 +45,17 @@ TEST(SettingsTest, IncorrectSetup) {
   // Incorrect number of bins.
   EXPECT_THROW(s.num_bins(-10), SettingsError);
   EXPECT_THROW(s.num_bins(0), SettingsError);
+  // Incorrect number of threads.
+  EXPECT_THROW(s.num_threads(-1), SettingsError);
+  EXPECT_THROW(s.num_threads(0), SettingsError);
+  // Incorrect BDD memory budget.
+  EXPECT_THROW(s.bdd_memory(-1), SettingsError);
+  // Incorrect BDD fork depth.
+  EXPECT_THROW(s.bdd_fork_depth(-1), SettingsError);
+  // Incorrect number of top products.
+  EXPECT_THROW(s.top_products(-1), SettingsError);
+  // Incorrect number of simulation trials.
+  EXPECT_THROW(s.monte_carlo(-1), SettingsError);
   // Incorrect seed.
   EXPECT_THROW(s.seed(-1), SettingsError);
   // Incorrect mission time.
@@ -57,6 +68,9 @@ TEST(SettingsTest, IncorrectSetup) {
   EXPECT_NO_THROW(s.time_step(1));
   EXPECT_NO_THROW(s.safety_integrity_levels(true));
   EXPECT_THROW(s.time_step(0), SettingsError);
+  // Incorrect time step tolerance.
+  EXPECT_THROW(s.time_tolerance(-1e-3), SettingsError);
+  EXPECT_THROW(s.time_tolerance(1), SettingsError);
 }
 
 TEST(SettingsTest, CorrectSetup) {
@@ -95,6 +109,29 @@ TEST(SettingsTest, CorrectSetup) {
   // Correct seed.
   EXPECT_NO_THROW(s.seed(1));
 
+  // Correct number of simulation trials.
+  EXPECT_NO_THROW(s.monte_carlo(0));
+  EXPECT_NO_THROW(s.monte_carlo(1e6));
+  EXPECT_TRUE(s.probability_analysis());
+  EXPECT_NO_THROW(s.monte_carlo(0));
+
+  // Correct number of threads.
+  EXPECT_NO_THROW(s.num_threads(1));
+  EXPECT_NO_THROW(s.num_threads(32));
+
+  // Correct BDD memory budget.
+  EXPECT_NO_THROW(s.bdd_memory(0));
+  EXPECT_NO_THROW(s.bdd_memory(512));
+
+  // Correct BDD fork depth.
+  EXPECT_NO_THROW(s.bdd_fork_depth(0));
+  EXPECT_NO_THROW(s.bdd_fork_depth(8));
+
+  // Correct number of top products.
+  EXPECT_NO_THROW(s.top_products(0));
+  EXPECT_NO_THROW(s.top_products(100));
+  EXPECT_TRUE(s.probability_analysis());
+
   // Correct mission time.
   EXPECT_NO_THROW(s.mission_time(0));
   EXPECT_NO_THROW(s.mission_time(10));
@@ -105,6 +142,10 @@ TEST(SettingsTest, CorrectSetup) {
   EXPECT_NO_THROW(s.time_step(10));
   EXPECT_NO_THROW(s.time_step(1e6));
 
+  // Correct time step tolerance.
+  EXPECT_NO_THROW(s.time_tolerance(0));
+  EXPECT_NO_THROW(s.time_tolerance(1e-4));
+
   // Correct request for the SIL.
   EXPECT_NO_THROW(s.safety_integrity_levels(true));
   EXPECT_NO_THROW(s.safety_integrity_levels(false));
@@ -122,6 +163,11 @@ TEST(SettingsTest, SetupForPrimeImplicants) {
   EXPECT_NO_THROW(s.approximation("none"));
   EXPECT_THROW(s.approximation("rare-event"), SettingsError);
   EXPECT_THROW(s.approximation("mcub"), SettingsError);
+  // Prime implicants cannot be simulated.
+  EXPECT_THROW(s.monte_carlo(1000), SettingsError);
+  EXPECT_NO_THROW(s.prime_implicants(false));
+  ASSERT_NO_THROW(s.monte_carlo(1000));
+  EXPECT_THROW(s.prime_implicants(true), SettingsError);
 }
 
 }  // namespace test